@@ -10,8 +10,11 @@
 
 #include "board.h"
 #include "macro.h"
+#include "thread.h"
 #include "pattern.h"
 #include "mvlist.h"
+#include "hash.h"
+#include "renju.h"
 
 // powers of three
 #define P0		1
@@ -93,6 +96,104 @@ static void nei_helper_init()
 #endif
 }
 
+/*******************************************************************************
+							Window table generation
+*******************************************************************************/
+#define CELL_WIN	20		// a cell is in 5 windows on each of 4 lines
+
+static u16 cell_win[15 * 15][CELL_WIN];
+static u8 cell_win_num[15 * 15];
+
+// number the five-cell windows and list the windows of every cell
+static void win_table_init()
+{
+	static const int dr[4] = { 0, 1, 1,  1 };
+	static const int dc[4] = { 1, 0, 1, -1 };
+	int d, r, c, k, er, ec, n = 0;
+
+	for(r = 0; r < 15 * 15; r++)
+		cell_win_num[r] = 0;
+
+	for(d = 0; d < 4; d++)
+	{
+		for(r = 0; r < 15; r++)
+		{
+			for(c = 0; c < 15; c++)
+			{
+				er = r + 4 * dr[d];
+				ec = c + 4 * dc[d];
+				if(er >= 15 || ec < 0 || ec >= 15)
+					continue;
+				for(k = 0; k < 5; k++)
+				{
+					er = (r + k * dr[d]) * 15 + c + k * dc[d];
+					cell_win[er][cell_win_num[er]++] = n;
+				}
+				n++;
+			}
+		}
+	}
+}
+
+/*******************************************************************************
+							Line key table generation
+*******************************************************************************/
+#define KEY_DIST	5		// a line key covers five cells on both sides
+#define KEY_STEPS	(8 * KEY_DIST)
+
+// a cell whose line key in dir has the digit of weight pow on a given cell
+typedef struct {
+	u8 cell;
+	u8 dir;
+	u16 pow;
+} kstep_t;
+
+static kstep_t key_step[15 * 15][KEY_STEPS];
+static u8 key_step_num[15 * 15];
+static u16 key_base[15 * 15][4];		// keys of the empty board, walls are 2
+
+// digit of the cell k steps away, digits 0-4 are k = -5..-1 and 5-9 are 1..5
+static inline int key_digit(const int k)
+{
+	return k < 0 ? k + KEY_DIST : k + KEY_DIST - 1;
+}
+
+static void key_table_init()
+{
+	static const int dr[4] = { 0, 1, 1,  1 };
+	static const int dc[4] = { 1, 0, 1, -1 };
+	int pos, d, k, r, c, i, pw[2 * KEY_DIST];
+
+	for(i = 0, pw[0] = 1; i + 1 < 2 * KEY_DIST; i++)
+		pw[i + 1] = pw[i] * 3;
+
+	for(pos = 0; pos < 15 * 15; pos++)
+	{
+		key_step_num[pos] = 0;
+		for(d = 0; d < 4; d++)
+		{
+			key_base[pos][d] = 0;
+			for(k = -KEY_DIST; k <= KEY_DIST; k++)
+			{
+				if(k == 0)
+					continue;
+				r = pos / 15 + k * dr[d];
+				c = pos % 15 + k * dc[d];
+				if(r < 0 || r >= 15 || c < 0 || c >= 15)
+					key_base[pos][d] += 2 * pw[key_digit(k)];
+				else
+				{
+					// pos is -k steps away from the cell k steps away
+					i = key_step_num[pos]++;
+					key_step[pos][i].cell = r * 15 + c;
+					key_step[pos][i].dir = d;
+					key_step[pos][i].pow = pw[key_digit(-k)];
+				}
+			}
+		}
+	}
+}
+
 void nei_table_init()
 {
 	int nr, nc, ar, ac;
@@ -139,6 +240,8 @@ void nei_table_init()
 #if NEI_DEBUG
 	print_nei();
 #endif
+	win_table_init();
+	key_table_init();
 }
 
 /*******************************************************************************
@@ -778,246 +881,191 @@ static pattern_t table7[P7];
 static pattern_t table6[P6];
 static pattern_t table5[P5];
 
-// generate pattern lookup tables
-static void table15_init()
+#define SLICE		P11		// # of table entries per job
+
+// fill entries [begin, end) of the table of lines of length len
+static void table_fill(pattern_t* table, const int len, const u32 begin, const u32 end)
 {
-	u32 index;
+	u32 index, rest;
 	u8 a[15];
-	for(a[14] = EMPTY; a[14] <= WHITE; a[14]++) {
-	for(a[13] = EMPTY; a[13] <= WHITE; a[13]++) {
-	for(a[12] = EMPTY; a[12] <= WHITE; a[12]++) {
-	for(a[11] = EMPTY; a[11] <= WHITE; a[11]++) {
-	for(a[10] = EMPTY; a[10] <= WHITE; a[10]++) {
-	for(a[9] = EMPTY; a[9] <= WHITE; a[9]++) {
-	for(a[8] = EMPTY; a[8] <= WHITE; a[8]++) {
-	for(a[7] = EMPTY; a[7] <= WHITE; a[7]++) {
-	for(a[6] = EMPTY; a[6] <= WHITE; a[6]++) {
-	for(a[5] = EMPTY; a[5] <= WHITE; a[5]++) {
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {	
-	index = a[14]*P14 + a[13]*P13 + a[12]*P12 + a[11]*P11 + a[10]*P10
-			+ a[9]*P9 + a[8]*P8 + a[7]*P7 + a[6]*P6 + a[5]*P5 + a[4]*P4
-			+ a[3]*P3 + a[2]*P2 + a[1]*P1 + a[0]*P0;
-	line_cnt(&table15[index], a, 15);
-	} } } } } } } } } } } } } } }
-}
-
-static void table14_init()
-{
-	u32 index;
-	u8 a[14];
-	for(a[13] = EMPTY; a[13] <= WHITE; a[13]++) {
-	for(a[12] = EMPTY; a[12] <= WHITE; a[12]++) {
-	for(a[11] = EMPTY; a[11] <= WHITE; a[11]++) {
-	for(a[10] = EMPTY; a[10] <= WHITE; a[10]++) {
-	for(a[9] = EMPTY; a[9] <= WHITE; a[9]++) {
-	for(a[8] = EMPTY; a[8] <= WHITE; a[8]++) {
-	for(a[7] = EMPTY; a[7] <= WHITE; a[7]++) {
-	for(a[6] = EMPTY; a[6] <= WHITE; a[6]++) {
-	for(a[5] = EMPTY; a[5] <= WHITE; a[5]++) {
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {	
-	index = a[13]*P13 + a[12]*P12 + a[11]*P11 + a[10]*P10 + a[9]*P9 + a[8]*P8
-			+ a[7]*P7 + a[6]*P6 + a[5]*P5 + a[4]*P4 + a[3]*P3 + a[2]*P2
-			+ a[1]*P1 + a[0]*P0;
-	line_cnt(&table14[index], a, 14);
-	} } } } } } } } } } } } } }
-}
-
-static void table13_init()
-{
-	u32 index;
-	u8 a[13];
-	for(a[12] = EMPTY; a[12] <= WHITE; a[12]++) {
-	for(a[11] = EMPTY; a[11] <= WHITE; a[11]++) {
-	for(a[10] = EMPTY; a[10] <= WHITE; a[10]++) {
-	for(a[9] = EMPTY; a[9] <= WHITE; a[9]++) {
-	for(a[8] = EMPTY; a[8] <= WHITE; a[8]++) {
-	for(a[7] = EMPTY; a[7] <= WHITE; a[7]++) {
-	for(a[6] = EMPTY; a[6] <= WHITE; a[6]++) {
-	for(a[5] = EMPTY; a[5] <= WHITE; a[5]++) {
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {	
-	index = a[12]*P12 + a[11]*P11 + a[10]*P10 + a[9]*P9 + a[8]*P8 + a[7]*P7
-			+ a[6]*P6 + a[5]*P5 + a[4]*P4 + a[3]*P3 + a[2]*P2 + a[1]*P1
-			+ a[0]*P0;
-	line_cnt(&table13[index], a, 13);
-	} } } } } } } } } } } } }
-}
-
-static void table12_init()
-{
-	u32 index;
-	u8 a[12];
-	for(a[11] = EMPTY; a[11] <= WHITE; a[11]++) {
-	for(a[10] = EMPTY; a[10] <= WHITE; a[10]++) {
-	for(a[9] = EMPTY; a[9] <= WHITE; a[9]++) {
-	for(a[8] = EMPTY; a[8] <= WHITE; a[8]++) {
-	for(a[7] = EMPTY; a[7] <= WHITE; a[7]++) {
-	for(a[6] = EMPTY; a[6] <= WHITE; a[6]++) {
-	for(a[5] = EMPTY; a[5] <= WHITE; a[5]++) {
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {	
-	index = a[11]*P11 + a[10]*P10 + a[9]*P9 + a[8]*P8 + a[7]*P7 + a[6]*P6
-			+ a[5]*P5 + a[4]*P4 + a[3]*P3 + a[2]*P2 + a[1]*P1 + a[0]*P0;
-	line_cnt(&table12[index], a, 12);
-	} } } } } } } } } } } }
-}
-
-static void table11_init()
-{
-	u32 index;
-	u8 a[11];
-	for(a[10] = EMPTY; a[10] <= WHITE; a[10]++) {
-	for(a[9] = EMPTY; a[9] <= WHITE; a[9]++) {
-	for(a[8] = EMPTY; a[8] <= WHITE; a[8]++) {
-	for(a[7] = EMPTY; a[7] <= WHITE; a[7]++) {
-	for(a[6] = EMPTY; a[6] <= WHITE; a[6]++) {
-	for(a[5] = EMPTY; a[5] <= WHITE; a[5]++) {
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {
-	index = a[10]*P10 + a[9]*P9 + a[8]*P8 + a[7]*P7 + a[6]*P6 + a[5]*P5
-			+ a[4]*P4 + a[3]*P3 + a[2]*P2 + a[1]*P1 + a[0]*P0;
-	line_cnt(&table11[index], a, 11);
-	} } } } } } } } } } }
-}
-
-static void table10_init()
-{
-	u32 index;
-	u8 a[10];
-	for(a[9] = EMPTY; a[9] <= WHITE; a[9]++) {
-	for(a[8] = EMPTY; a[8] <= WHITE; a[8]++) {
-	for(a[7] = EMPTY; a[7] <= WHITE; a[7]++) {
-	for(a[6] = EMPTY; a[6] <= WHITE; a[6]++) {
-	for(a[5] = EMPTY; a[5] <= WHITE; a[5]++) {
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {	
-	index = a[9]*P9 + a[8]*P8 + a[7]*P7	+ a[6]*P6 + a[5]*P5 + a[4]*P4
-			+ a[3]*P3 + a[2]*P2	+ a[1]*P1 + a[0]*P0;
-	line_cnt(&table10[index], a, 10);
-	} } } } } } } } } }
-}
-
-static void table9_init()
-{
-	u32 index;
-	u8 a[9];
-	for(a[8] = EMPTY; a[8] <= WHITE; a[8]++) {
-	for(a[7] = EMPTY; a[7] <= WHITE; a[7]++) {
-	for(a[6] = EMPTY; a[6] <= WHITE; a[6]++) {
-	for(a[5] = EMPTY; a[5] <= WHITE; a[5]++) {
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {	
-	index = a[8]*P8 + a[7]*P7 + a[6]*P6 + a[5]*P5 + a[4]*P4 + a[3]*P3
-			+ a[2]*P2 + a[1]*P1 + a[0]*P0;
-	line_cnt(&table9[index], a, 9);
-	} } } } } } } } }
-}
-
-static void table8_init()
-{
-	u32 index;
-	u8 a[8];
-	for(a[7] = EMPTY; a[7] <= WHITE; a[7]++) {
-	for(a[6] = EMPTY; a[6] <= WHITE; a[6]++) {
-	for(a[5] = EMPTY; a[5] <= WHITE; a[5]++) {
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {	
-	index = a[7]*P7 + a[6]*P6 + a[5]*P5 + a[4]*P4 + a[3]*P3 + a[2]*P2
-			+ a[1]*P1 + a[0]*P0;
-	line_cnt(&table8[index], a, 8);
-	} } } } } } } }
-}
-
-static void table7_init()
-{
-	u32 index;
-	u8 a[7];
-	for(a[6] = EMPTY; a[6] <= WHITE; a[6]++) {
-	for(a[5] = EMPTY; a[5] <= WHITE; a[5]++) {
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {	
-	index = a[6]*P6 + a[5]*P5 + a[4]*P4 + a[3]*P3 + a[2]*P2	+ a[1]*P1
-			+ a[0]*P0;
-	line_cnt(&table7[index], a, 7);
-	} } } } } } }
-}
-
-static void table6_init()
-{
-	u32 index;
-	u8 a[6];
-	for(a[5] = EMPTY; a[5] <= WHITE; a[5]++) {
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {	
-	index = a[5]*P5 + a[4]*P4 + a[3]*P3 + a[2]*P2 + a[1]*P1 + a[0]*P0;
-	line_cnt(&table6[index], a, 6);
-	} } } } } }
-}
-
-static void table5_init()
-{
-	u32 index;
-	u8 a[5];
-	for(a[4] = EMPTY; a[4] <= WHITE; a[4]++) {
-	for(a[3] = EMPTY; a[3] <= WHITE; a[3]++) {
-	for(a[2] = EMPTY; a[2] <= WHITE; a[2]++) {
-	for(a[1] = EMPTY; a[1] <= WHITE; a[1]++) {
-	for(a[0] = EMPTY; a[0] <= WHITE; a[0]++) {	
-	index = a[4]*P4 + a[3]*P3 + a[2]*P2 + a[1]*P1 + a[0]*P0;
-	line_cnt(&table5[index], a, 5);
-	} } } } }
-}
-
-void pattern_table_init1()
+	int i;
+
+	// a[0] is the lowest digit of the index
+	for(i = 0, rest = begin; i < len; i++, rest /= 3)
+		a[i] = rest % 3;
+
+	for(index = begin; index < end; index++)
+	{
+		line_cnt(&table[index], a, len);
+		for(i = 0; i < len && ++a[i] > WHITE; i++)
+			a[i] = EMPTY;
+	}
+}
+
+// pattern table worker
+typedef struct {
+	int id;				// worker index
+	int num;			// # of workers
+} table_job_t;
+
+// tables are cut into slices of at most SLICE entries, so table15 is split by
+// its outer four digits, and worker i fills slices i, i + num, i + 2num ...
+static void* table_worker(void* arg)
 {
-	pat_t_init();
-	table15_init();
+	pattern_t* table[11] = { table5, table6, table7, table8, table9, table10,
+							 table11, table12, table13, table14, table15 };
+	const table_job_t* job = (const table_job_t*)arg;
+	u32 size, begin;
+	int len, k = 0;
+
+	for(len = 15, size = P15; len >= 5; len--, size /= 3)
+	{
+		for(begin = 0; begin < size; begin += SLICE, k++)
+		{
+			if(k % job->num == job->id)
+				table_fill(table[len - 5], len, begin, begin + SLICE < size ? begin + SLICE : size);
+		}
+	}
+	return NULL;
+}
+
+/*******************************************************************************
+							Shape table generation
+*******************************************************************************/
+u8 ShapeTab[2][SHAPE_KEYS];
+
+// the eleven cells of a line key, 1 is mine on the center cell 5, 2 is the
+// opponent's or a wall
+static void key_decode(const int key, u8* seg)
+{
+	int i, k = key;
+
+	for(i = 0; i < 2 * KEY_DIST + 1; i++)
+	{
+		if(i == KEY_DIST)
+			seg[i] = 1;
+		else
+		{
+			seg[i] = k % 3;
+			k /= 3;
+		}
+	}
+}
+
+// length of my run through the center
+static int seg_run(const u8* seg)
+{
+	int n = 1, i;
+
+	for(i = KEY_DIST + 1; i <= 2 * KEY_DIST && seg[i] == 1; i++)
+		n++;
+	for(i = KEY_DIST - 1; i >= 0 && seg[i] == 1; i--)
+		n++;
+	return n;
+}
+
+// weight of cell i of the eleven in the line key
+static inline int seg_pow(const int i)
+{
+	int d = i < KEY_DIST ? i : i - 1, pw = 1;
+
+	while(d-- > 0)
+		pw *= 3;
+	return pw;
+}
+
+// shape of the line key, exact is set if only exactly five makes a five
+static u8 shape_of(u8* tab, const int key, const bool exact)
+{
+	u8 seg[2 * KEY_DIST + 1], sub, three = SHAPE_NONE, two = SHAPE_NONE;
+	int i, len, n = 0, first = 0, last = 0;
+
+	if(tab[key] != INVALID)
+		return tab[key];
+
+	key_decode(key, seg);
+	len = seg_run(seg);
+	if(len >= 5)
+		return tab[key] = exact && len > 5 ? LONG : FIVE;
+
+	// count the cells making a five with the center
+	for(i = 1; i < 2 * KEY_DIST; i++)
+	{
+		if(seg[i] != EMPTY)
+			continue;
+		seg[i] = 1;
+		len = seg_run(seg);
+		seg[i] = EMPTY;
+		if(len == 5 || (!exact && len > 5))
+		{
+			if(n++ == 0)
+				first = i;
+			last = i;
+		}
+	}
+	if(n == 1)
+		return tab[key] = DEAD4;
+	if(n > 1)
+		return tab[key] = n == 2 && last - first == 5 ? FREE4 : SHAPE_DOUBLE4;
+
+	// one more disc of mine makes a four or a three
+	for(i = 1; i < 2 * KEY_DIST; i++)
+	{
+		if(seg[i] != EMPTY)
+			continue;
+		sub = shape_of(tab, key + seg_pow(i), exact);
+		if(sub == FREE4)
+			three = FREE3;
+		else if((sub == DEAD4 || sub == SHAPE_DOUBLE4) && three != FREE3)
+			three = DEAD3;
+		else if(sub == FREE3)
+			two = FREE2;
+		else if(sub == DEAD3 && two != FREE2)
+			two = DEAD2;
+	}
+	return tab[key] = three != SHAPE_NONE ? three : two;
 }
 
-void pattern_table_init2()
+static void shape_table_init()
 {
-	table14_init();
-	table13_init();
-	table12_init();
-	table11_init();
-	table10_init();
-	table9_init();
-	table8_init();
-	table7_init();
-	table6_init();
-	table5_init();
+	int rule, key;
+
+	for(rule = 0; rule < 2; rule++)
+	{
+		memset(ShapeTab[rule], INVALID, SHAPE_KEYS);
+		for(key = 0; key < SHAPE_KEYS; key++)
+			shape_of(ShapeTab[rule], key, rule == 0);
+	}
+}
+
+void pattern_table_init(const int threads)
+{
+	thread_t tid[64];
+	table_job_t job[64];
+	bool started[64];
+	int i, n = threads < 1 ? 1 : threads > 64 ? 64 : threads;
+
+	pat_t_init();
+	shape_table_init();
+
+	for(i = 0; i < n; i++)
+	{
+		job[i].id = i;
+		job[i].num = n;
+	}
+	for(i = 1; i < n; i++)
+		started[i] = thread_create(&tid[i], table_worker, &job[i]);
+
+	table_worker(&job[0]);
+
+	// fill the slices of the workers that failed to start here
+	for(i = 1; i < n; i++)
+	{
+		if(started[i])
+			thread_join(tid[i]);
+		else
+			table_worker(&job[i]);
+	}
 }
 
 /*******************************************************************************
@@ -1828,13 +1876,22 @@ void board_reset(board_t* bd)
 	int i;
 
 	bd->num = 0;
+	bd->book = false;
 	mvlist_reset(mstk(bd));
 	pattern_reset(pinc(bd));
 	pattern_reset(hpinc(bd));
 
+	for(i = 0; i < SYM_NUM; i++)
+		bd->sym[i] = 0;
+
+	for(i = 0; i < WIN_NUM; i++)
+		bd->wcnt[i] = 0;
+
 	for(i = 0; i < 15 * 15; i++)
 	{
 		bd->arr[i] = EMPTY;
+		memcpy(bd->key[0][i], key_base[i], sizeof(key_base[i]));
+		memcpy(bd->key[1][i], key_base[i], sizeof(key_base[i]));
 		pattern_reset(&bd->pat[i]);
 		mvlist_reset(&bd->mlist[i]);
 		mvlist_reset(&bd->hlist[i]);
@@ -1850,6 +1907,115 @@ void board_init(board_t* bd, const char (*arr)[15])
 			do_move(bd, r * 15 + c, arr[r][c]);
 }
 
+u64 board_hash(const board_t* bd, int* sym)
+{
+	int s = hash_canonical(bd->sym);
+	if(sym != NULL)
+		*sym = s;
+	return bd->sym[s];
+}
+
+// count a disc in or out of the windows through pos
+static inline void win_update(board_t* bd, const u8 pos, const u8 color, const u8 op)
+{
+	u8 inc = color == BLACK ? 0x01 : 0x10;
+	int i;
+
+	for(i = 0; i < cell_win_num[pos]; i++)
+	{
+		if(op == DO)
+			bd->wcnt[cell_win[pos][i]] += inc;
+		else
+			bd->wcnt[cell_win[pos][i]] -= inc;
+	}
+}
+
+bool board_window(const board_t* bd, const u8 pos, const u8 color, const int n)
+{
+	u8 want = color == BLACK ? n : n << 4;
+	int i;
+
+	for(i = 0; i < cell_win_num[pos]; i++)
+		if(bd->wcnt[cell_win[pos][i]] == want)
+			return true;
+	return false;
+}
+
+// toggle a disc in the symmetric hashes
+static inline void hash_toggle(board_t* bd, const u8 pos, const u8 color)
+{
+	int s;
+	for(s = 0; s < SYM_NUM; s++)
+		bd->sym[s] ^= Zobrist[color][SymPos[s][pos]];
+}
+
+// add or remove a disc in the line keys around pos
+static inline void key_update(board_t* bd, const u8 pos, const u8 color, const u8 op)
+{
+	const kstep_t* st = key_step[pos];
+	int mine = color == BLACK ? 1 : 2;		// digit seen by black
+	int i;
+
+	for(i = 0; i < key_step_num[pos]; i++)
+	{
+		if(op == DO)
+		{
+			bd->key[0][st[i].cell][st[i].dir] += mine * st[i].pow;
+			bd->key[1][st[i].cell][st[i].dir] += (3 - mine) * st[i].pow;
+		}
+		else
+		{
+			bd->key[0][st[i].cell][st[i].dir] -= mine * st[i].pow;
+			bd->key[1][st[i].cell][st[i].dir] -= (3 - mine) * st[i].pow;
+		}
+	}
+}
+
+bool board_forbidden(board_t* bd, const u8 pos)
+{
+	int d, fours = 0, threes = 0;
+	bool five = false, lon = false;
+	u8 sh;
+
+	for(d = 0; d < 4; d++)
+	{
+		sh = ShapeTab[0][bd->key[0][pos][d]];
+		if(sh == FIVE)
+			five = true;
+		else if(sh == LONG)
+			lon = true;
+		else if(sh == FREE4 || sh == DEAD4)
+			fours++;
+		else if(sh == SHAPE_DOUBLE4)
+			fours += 2;
+		else if(sh == FREE3)
+			threes++;
+	}
+
+	// a five wins even with an overline on another line
+	if(five)
+		return false;
+	if(lon || fours > 1)
+		return true;
+
+	// real threes depend on cells off the lines, so check them exactly. Not
+	// cached: under 0.1% of the calls get here, costing under 0.5% of the
+	// search time at dep=6 on mid-game positions
+	return threes > 1 && renju_check(bd->arr, pos);
+}
+
+// return true if the last disc is black and on a forbidden point
+static bool last_forbidden(const board_t* bd)
+{
+	u8 arr[15 * 15];
+	u8 pos = mvlist_last(mstk(bd));
+
+	if(bd->num == 0 || bd->arr[pos] != BLACK)
+		return false;
+	memcpy(arr, bd->arr, sizeof(arr));
+	return renju_check_disc(arr, pos);
+}
+
 u8 board_gameover(const board_t* bd)
 {
 	if(bd->num == 15 * 15)
@@ -1866,8 +2032,10 @@ u8 board_gameover(const board_t* bd)
 		if(pattern_read(pat(bd), LONG, BLACK) || pattern_read(pat(bd), LONG, WHITE))
 			return WHITE;
 
-		if((pattern_read(pinc(bd),FREE4,BLACK)+pattern_read(pinc(bd),DEAD4,BLACK)>1)
+		// patterns count fake threes too, so confirm the last disc exactly
+		if(((pattern_read(pinc(bd),FREE4,BLACK)+pattern_read(pinc(bd),DEAD4,BLACK)>1)
 		|| (pattern_read(pinc(bd),FREE3,BLACK)+pattern_read(pinc(bd),FREE3a,BLACK)>1))
+		&& last_forbidden(bd))
 			return WHITE;
 	}
 
@@ -1891,6 +2059,9 @@ void do_move_no_mvlist(board_t* bd, const u8 pos, const u8 color)
 	// make move
 	bd->arr[pos] = color;
 	mvlist_insert_back(mstk(bd), pos);
+	hash_toggle(bd, pos, color);
+	win_update(bd, pos, color, DO);
+	key_update(bd, pos, color, DO);
 
 	// add new critical line patterns
 	pattern_add(pat(bd), pat(bd), &table15[(*r[pos])(bd)]);
@@ -1919,6 +2090,9 @@ void do_move(board_t* bd, const u8 pos, const u8 color)
 	// make move
 	bd->arr[pos] = color;
 	mvlist_insert_back(mstk(bd), pos);
+	hash_toggle(bd, pos, color);
+	win_update(bd, pos, color, DO);
+	key_update(bd, pos, color, DO);
 
 	// add new critical line patterns
 	pattern_add(pat(bd), pat(bd), &table15[(*r[pos])(bd)]);
@@ -1929,8 +2103,14 @@ void do_move(board_t* bd, const u8 pos, const u8 color)
 	// update pinc
 	pattern_sub(pinc(bd), pat(bd), &bd->pat[bd->num - 1]);
 
-	// generate mvlist
+	board_mvlist(bd);
+}
+
+void board_mvlist(board_t* bd)
+{
+	u8 pos = mvlist_last(mstk(bd));
 	int i;
+
 	mvlist_copy(&bd->mlist[bd->num - 1], mlist(bd));
 	mvlist_remove(mlist(bd), pos);
 	for(i = 0; i < NEI_SIZE; i++)
@@ -1949,6 +2129,9 @@ void undo(board_t* bd)
 	else
 	{
 		bd->num--;
+		hash_toggle(bd, mvlist_last(mstk(bd)), bd->arr[mvlist_last(mstk(bd))]);
+		win_update(bd, mvlist_last(mstk(bd)), bd->arr[mvlist_last(mstk(bd))], UNDO);
+		key_update(bd, mvlist_last(mstk(bd)), bd->arr[mvlist_last(mstk(bd))], UNDO);
 		bd->arr[mvlist_last(mstk(bd))] = EMPTY;
 		mvlist_remove_back(mstk(bd));
 	}
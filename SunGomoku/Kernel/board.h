@@ -17,6 +17,14 @@ extern "C" {
 
 #include "pattern.h"
 #include "mvlist.h"
+#include "hash.h"
+
+#define WIN_NUM		572		// # of five-cell windows on the board
+#define SHAPE_KEYS	59049	// 3^10 line keys of the ten cells around a cell
+
+// shape codes besides LONG, FIVE, FREE4, DEAD4, FREE3, DEAD3, FREE2 and DEAD2
+#define SHAPE_DOUBLE4	PAT_NUM			// two fours on one line
+#define SHAPE_NONE		(PAT_NUM + 1)	// less than a two
 
 #define mstk(bd)	&bd->mstk
 #define pinc(bd)	&bd->pinc
@@ -35,18 +43,29 @@ typedef struct {
 	pattern_t pat[15 * 15];		// pattern stack
 	mvlist_t mlist[15 * 15];	// mvlist stack
 	mvlist_t hlist[15 * 15];	// heuristic mvlist stack
+	u64 sym[SYM_NUM];			// Zobrist hash under every symmetry
+	u8 wcnt[WIN_NUM];			// black discs in the low and white in the high
+								// nibble of every five-cell window
+	u16 key[2][15 * 15][4];		// line keys of every cell in the four
+								// directions seen by black and white
+	bool book;					// set while the game follows the opening book
 } board_t;
 
+extern bool isForbidden;
+
+// shape of a line key for a disc on its center, [0] if only exactly five
+// stones make a five, [1] if more do too
+extern u8 ShapeTab[2][SHAPE_KEYS];
+
 /*
  * Generate neighbor lookup table.
  */
 void nei_table_init();
 
 /*
- * Generate pattern lookup tables.
+ * Generate pattern and shape lookup tables on a number of threads.
  */
-void pattern_table_init1();
-void pattern_table_init2();
+void pattern_table_init(const int threads);
 
 /*
  * Reset a board.
@@ -58,6 +77,36 @@ void board_reset(board_t* bd);
  */
 void board_init(board_t* bd, const char (*arr)[15]);
 
+/*
+ * Return the canonical hash of the position, the same in every orientation.
+ * Set sym to the symmetry taking the board to the canonical orientation if it
+ * isn't NULL.
+ */
+u64 board_hash(const board_t* bd, int* sym);
+
+/*
+ * Return the shape color makes in direction dir by moving on the empty
+ * position pos, dir 0 is a row, 1 a column, 2 the main and 3 the anti
+ * diagonal. Black's threes may be fake under the renju rule.
+ */
+static inline u8 board_shape(const board_t* bd, const u8 pos, const u8 color, const int dir)
+{
+	return ShapeTab[color == BLACK && isForbidden ? 0 : 1][bd->key[color - 1][pos][dir]];
+}
+
+/*
+ * Return true if black can't move on the empty position pos under the renju
+ * rule.
+ */
+bool board_forbidden(board_t* bd, const u8 pos);
+
+/*
+ * Return true if pos is in a five-cell window holding n discs of color and
+ * none of the other. With n = 4 pos completes or blocks a five, with n = 3
+ * it makes or blocks a four.
+ */
+bool board_window(const board_t* bd, const u8 pos, const u8 color, const int n);
+
 /*
  * Return the win side if game is over or return false.
  */
@@ -73,6 +122,11 @@ void do_move_no_mvlist(board_t* bd, const u8 pos, const u8 color);
  */
 void do_move(board_t* bd, const u8 pos, const u8 color);
 
+/*
+ * Generate mlist(bd) from the previous one after do_move_no_mvlist().
+ */
+void board_mvlist(board_t* bd);
+
 /*
  * Undo the most recent move.
  */
@@ -12,12 +12,15 @@
 #include "macro.h"
 #include "tree.h"
 #include "board.h"
+#include "hash.h"
+#include "mapfile.h"
 
 // #include "interface.h"
 
+extern bool isForbidden;
+
 #define DIRECT_NUM		6
 #define INDIRECT_NUM	5
-#define TRANS_NUM		8
 #define MAX_DFS_DEP		13
 
 /*******************************************************************************
@@ -64,32 +67,90 @@ static int header_id[INDIRECT_NUM] = {
 };
 #endif
 
-// opening tree pointer
-static tree_t* optree = NULL;
-
-bool book_isload()
-{
-	if(optree != NULL && optree->root->down != NULL)
-		return true;
-	else
-		return false;
-}
-
-void book_reset()
-{
-	if(optree->root != NULL)
-		tree_reset(optree);
-}
-
-void book_delete()
-{
-	if(optree != NULL)
-		tree_delete(optree);
-}
+// compiled book file layout: head, slots, moves
+#define BOOK_MAGIC		0x4b424753		// "SGBK" in little endian
+#define BOOK_VERSION	4
+
+#define BOOK_NUM		(DIRECT_NUM + INDIRECT_NUM)
+
+// rule bits of book moves, the .lib books are used with both rules
+#define BOOK_RULE(forbidden)	(1 << (forbidden))
+#define BOOK_RULES		(BOOK_RULE(0) | BOOK_RULE(1))
+
+// hash table slot of a position, empty if key is 0
+typedef struct {
+	u64 key;			// canonical hash of the position
+	u32 move;			// index of the first successor move
+	u16 num;			// successor number, 0 for a book leaf
+	u8 rule;			// rule bits of the position
+	u8 reserved;
+} bslot_t;
+
+// successor move with its statistics over all books and the analysis
+typedef struct {
+	u8 pos;				// position in the canonical orientation
+	u8 dist;			// shortest # of moves to the end of a book line
+	u16 books;			// bit i is set if book i has the move
+	u32 freq;			// # of book lines and analyses through the move
+	int32_t score;		// analysis score for the mover
+	u8 dep;				// analysis depth, 0 if only from the .lib books
+	u8 rule;			// rule bits the move is good for
+	u16 reserved;
+} bmove_t;
+
+// compiled book head
+typedef struct {
+	u32 magic;
+	u32 version;
+	u32 slots;			// slot number, a power of 2
+	u32 moves;			// move number
+	u32 books;			// # of books merged
+	u32 reserved;
+} bhead_t;
+
+// merged book table
+typedef struct {
+	bslot_t* slot;
+	u32 size;
+	bmove_t* move;
+	u32 moves;
+} btable_t;
+
+// (position, successor) pair collected from a tree
+typedef struct {
+	u64 key;
+	u32 seq;			// collection order, keeps the book move order
+	u8 move;			// INVALID for the position itself
+	u8 dist;
+	u16 books;
+	u32 freq;
+	int32_t score;
+	u8 dep;
+	u8 rule;
+} brec_t;
+
+// growing brec_t array
+typedef struct {
+	brec_t* rec;
+	u32 num;
+	u32 cap;
+} bcollect_t;
+
+// compiled book, NULL if not mapped
+static const bhead_t* Flat = NULL;
+static size_t FlatSize = 0;
+
+// table built from the .lib books without a compiled book
+static btable_t Built = { NULL, 0, NULL, 0 };
+
+// book shared by all threads, Slot is NULL if no book is open
+static const bslot_t* Slot = NULL;
+static u32 Mask = 0;
+static const bmove_t* Move = NULL;
 
 /*
- * Scan an opening file and insert nodes to optree.
- * @param [in]	The global variable opening tree.
+ * Scan an opening file and insert nodes to a tree.
+ * @param [in]	The opening tree.
  * @param [in]	The directory of the opening file.	
  * Return false if fails.
  * Notice: Only accept lib file without any comment.
@@ -97,39 +158,50 @@ void book_delete()
 static bool book_load(tree_t* tree, char* dir)
 {
 	FILE* fin;
-	u8 buf[2], pos, info, i;
+	u8* buf;
+	u8 pos, info;
+	long len, i;
 	u32 cnt = 1;
 	
 	if((fin = fopen(dir, "rb")) == NULL)
 	{
-		printf("can't open book file!\n");
+		fprintf(stderr, "can't open book file %s\n", dir);
 		return false;
 	}
 
-	// discard header and 78 xx.
-	if(dir[9] == '5')
+	// read the whole file at once
+	fseek(fin, 0, SEEK_END);
+	len = ftell(fin);
+	fseek(fin, 0, SEEK_SET);
+	buf = (u8*)malloc(len > 0 ? len : 1);
+	if(len < 0 || fread(buf, 1, len, fin) != (size_t)len)
 	{
-		for(i = 0; i < 44; i++)
-			if(fread(buf, 1, 1, fin));
+		fprintf(stderr, "can't read book file %s\n", dir);
+		free(buf);
+		fclose(fin);
+		return false;
 	}
+	fclose(fin);
+
+	// two bytes per node
+	tree_reserve(tree, len / 2 + 1);
+
+	// discard header and 78 xx.
+	if(dir[9] == '5')
+		i = 44;
 	else
 	{
-		while(fread(buf, 1, 1, fin) == 1)
-		{
-			if(buf[0] == 0x78)
-			{
-				if(fread(buf, 1, 1, fin));
-				break;
-			}
-		}
+		for(i = 0; i < len && buf[i] != 0x78; i++)
+			;
+		i += 2;
 	}
 
 	// starts from the second move
-	while(fread(buf, 1, 2, fin) == 2)
+	for(; i + 1 < len; i += 2)
 	{
 		cnt++;
-		pos = (buf[0] / 16) * 15 + buf[0] % 16 - 1;
-		info = buf[1];
+		pos = (buf[i] / 16) * 15 + buf[i] % 16 - 1;
+		info = buf[i + 1];
 
 		// set second move and third move node info
 		if(cnt == 2 || cnt == 3)
@@ -137,7 +209,8 @@ static bool book_load(tree_t* tree, char* dir)
 
 		if(info != MID && info != MID_RIGHT && info != LEAF && info != LEAF_RIGHT)
 		{
-			printf("node info error!\n");
+			fprintf(stderr, "node info error in %s\n", dir);
+			free(buf);
 			return false;
 		}
 
@@ -147,333 +220,490 @@ static bool book_load(tree_t* tree, char* dir)
 #endif
 	}
 
-	fclose(fin);
+	free(buf);
 	return true;
 }
 
-void book_choose_direct()
-{
-	int index = rand() % DIRECT_NUM;
-
-	if(optree == NULL)
-		optree = tree_init();
-	else
-		book_reset(optree);
-
-	if(!book_load(optree, opening_d[index]))
-		printf("failed to load books!\n");
-#if 0
-	putchar('\n');
-	preorder_traversal(optree);
-#endif
-}
-
-void book_choose_indirect()
-{
-	int index = rand() % INDIRECT_NUM;
-
-	if(optree == NULL)
-		optree = tree_init();
-	else
-		book_reset(optree);
-
-	if(!book_load(optree, opening_id[index]))
-		printf("failed to load books!\n");
-#if 0
-	putchar('\n');
-	preorder_traversal(optree);
-#endif
-}
-
 /*******************************************************************************
-							Board Transfrom functions
+							Table generation functions
 *******************************************************************************/
-static u8 cc_arr[255] = {
-	14,  29,  44,  59,  74,  89, 104, 119, 134, 149, 164, 179, 194, 209, 224,
-	13,  28,  43,  58,  73,  88, 103, 118, 133, 148, 163, 178, 193, 208, 223,
-	12,  27,  42,  57,  72,  87, 102, 117, 132, 147, 162, 177, 192, 207, 222,
-	11,  26,  41,  56,  71,  86, 101, 116, 131, 146, 161, 176, 191, 206, 221,
-	10,  25,  40,  55,  70,  85, 100, 115, 130, 145, 160, 175, 190, 205, 220,
-	 9,  24,  39,  54,  69,  84,  99, 114, 129, 144, 159, 174, 189, 204, 219,
-	 8,  23,  38,  53,  68,  83,  98, 113, 128, 143, 158, 173, 188, 203, 218,
-	 7,  22,  37,  52,  67,  82,  97, 112, 127, 142, 157, 172, 187, 202, 217,
-	 6,  21,  36,  51,  66,  81,  96, 111, 126, 141, 156, 171, 186, 201, 216,
-	 5,  20,  35,  50,  65,  80,  95, 110, 125, 140, 155, 170, 185, 200, 215,
-	 4,  19,  34,  49,  64,  79,  94, 109, 124, 139, 154, 169, 184, 199, 214,
-	 3,  18,  33,  48,  63,  78,  93, 108, 123, 138, 153, 168, 183, 198, 213,
-	 2,  17,  32,  47,  62,  77,  92, 107, 122, 137, 152, 167, 182, 197, 212,
-	 1,  16,  31,  46,  61,  76,  91, 106, 121, 136, 151, 166, 181, 196, 211,
-	 0,  15,  30,  45,  60,  75,  90, 105, 120, 135, 150, 165, 180, 195, 210
-};
-
-static u8 ref_arr[255] =
+// 0 marks empty slots, no position has it in practice
+static inline u64 book_key(const u64 hash)
 {
-	 14,  13,  12,  11,  10,   9,   8,   7,   6,   5,   4,   3,   2,   1,   0,
-	 29,  28,  27,  26,  25,  24,  23,  22,  21,  20,  19,  18,  17,  16,  15,
-	 44,  43,  42,  41,  40,  39,  38,  37,  36,  35,  34,  33,  32,  31,  30,
-	 59,  58,  57,  56,  55,  54,  53,  52,  51,  50,  49,  48,  47,  46,  45,
-	 74,  73,  72,  71,  70,  69,  68,  67,  66,  65,  64,  63,  62,  61,  60,
-	 89,  88,  87,  86,  85,  84,  83,  82,  81,  80,  79,  78,  77,  76,  75,
-	 104, 103, 102, 101, 100, 99,  98,  97,  96,  95,  94,  93,  92,  91,  90,
-	 119, 118, 117, 116, 115, 114, 113, 112, 111, 110, 109, 108, 107, 106, 105,
-	 134, 133, 132, 131, 130, 129, 128, 127, 126, 125, 124, 123, 122, 121, 120,
-	 149, 148, 147, 146, 145, 144, 143, 142, 141, 140, 139, 138, 137, 136, 135,
-	 164, 163, 162, 161, 160, 159, 158, 157, 156, 155, 154, 153, 152, 151, 150,
-	 179, 178, 177, 176, 175, 174, 173, 172, 171, 170, 169, 168, 167, 166, 165,
-	 194, 193, 192, 191, 190, 189, 188, 187, 186, 185, 184, 183, 182, 181, 180,
-	 209, 208, 207, 206, 205, 204, 203, 202, 201, 200, 199, 198, 197, 196, 195,
-	 224, 223, 222, 221, 220, 219, 218, 217, 216, 215, 214, 213, 212, 211, 210
-};
+	return hash ? hash : 1;
+}
 
-static void cc(board_t* bd)
+static brec_t* book_record(bcollect_t* col, const u64 key, const u8 move,
+	const u8 dist, const u16 books, const u32 freq)
 {
-	u8 arr[15* 15];
-	u8 pos, i;
-	mvlist_t tmp;
-	mvlist_reset(&tmp);
-
-	// array
-	for(i = 0; i < 15 * 15; i++)
-		arr[i] = bd->arr[cc_arr[i]];
-	for(i = 0; i < 15 * 15; i++)
-		bd->arr[i] = arr[i];
-
-	// mstk
-	mvlist_remove_all(&tmp);
-	pos = mvlist_first(mstk(bd));
-	while(pos != END)
+	if(col->num == col->cap)
 	{
-		mvlist_insert_back(&tmp, cc_arr[pos]);
-		pos = mvlist_next(mstk(bd), pos);
+		col->cap = col->cap ? col->cap * 2 : 1024;
+		col->rec = (brec_t*)realloc(col->rec, col->cap * sizeof(brec_t));
 	}
-	mvlist_copy(&tmp, mstk(bd));
-
-	// mlist
-	mvlist_remove_all(&tmp);
-	pos = mvlist_first(mlist(bd));
-	while(pos != END)
-	{
-		mvlist_insert_back(&tmp, cc_arr[pos]);
-		pos = mvlist_next(mlist(bd), pos);
-	}
-	mvlist_copy(&tmp, mlist(bd));
+	col->rec[col->num].key = key;
+	col->rec[col->num].seq = col->num;
+	col->rec[col->num].move = move;
+	col->rec[col->num].dist = dist;
+	col->rec[col->num].books = books;
+	col->rec[col->num].freq = freq;
+	col->rec[col->num].score = 0;
+	col->rec[col->num].dep = 0;
+	col->rec[col->num].rule = BOOK_RULES;
+	return &col->rec[col->num++];
+}
 
-	// hlist
-	mvlist_remove_all(&tmp);
-	pos = mvlist_first(hlist(bd));
-	while(pos != END)
+/*
+ * Record the position of node and its children in the canonical orientation.
+ * sym holds the hashes of the path above node under every symmetry. Set freq
+ * to the # of lines through node and dist to the length of its shortest one.
+ */
+static void book_collect(bcollect_t* col, const tree_t* tree, const u32 idx,
+	const u64* sym, const int ply, const int book, u32* freq, u8* dist)
+{
+	const tnode_t* node = &tree->node[idx];
+	u64 cur[SYM_NUM], key;
+	u8 color = ply % 2 ? WHITE : BLACK;
+	u32 child;
+	u32 f;
+	u8 d;
+	int s;
+
+	for(s = 0; s < SYM_NUM; s++)
+		cur[s] = sym[s] ^ Zobrist[color][SymPos[s][node->pos]];
+	s = hash_canonical(cur);
+	key = book_key(cur[s]);
+
+	book_record(col, key, INVALID, 0, 0, 0);
+	*freq = node->down == NIL ? 1 : 0;
+	*dist = node->down == NIL ? 0 : UCHAR_MAX;
+
+	for(child = node->down; child != NIL; child = tree->node[child].next)
 	{
-		mvlist_insert_back(&tmp, cc_arr[pos]);
-		pos = mvlist_next(hlist(bd), pos);
+		book_collect(col, tree, child, cur, ply + 1, book, &f, &d);
+		d = d < UCHAR_MAX ? d + 1 : d;
+		book_record(col, key, SymPos[s][tree->node[child].pos], d, 1 << book, f);
+		*freq += f;
+		if(d < *dist)
+			*dist = d;
 	}
-	mvlist_copy(&tmp, hlist(bd));
 }
 
-static void ref(board_t* bd)
+/*
+ * Record the positions of an analysis file written by sgbookgen, one per line:
+ * rule depth score best num, then the num moves of the position.
+ * Return false if the file can't be opened, bad lines are skipped.
+ */
+static bool book_collect_analysis(bcollect_t* col, const char* dir)
 {
-	u8 arr[15 * 15];
-	u8 pos, i;
-	mvlist_t tmp;
-	mvlist_reset(&tmp);
-
-	// array
-	for(i = 0; i < 15 * 15; i++)
-		arr[i] = bd->arr[ref_arr[i]];
-	for(i = 0; i < 15 * 15; i++)
-		bd->arr[i] = arr[i];
-
-	// mstk
-	mvlist_remove_all(&tmp);
-	pos = mvlist_first(mstk(bd));
-	while(pos != END)
-	{
-		mvlist_insert_back(&tmp, ref_arr[pos]);
-		pos = mvlist_next(mstk(bd), pos);
-	}
-	mvlist_copy(&tmp, mstk(bd));
+	FILE* fin;
+	u64 sym[SYM_NUM], key;
+	u8 used[15 * 15];
+	brec_t* rec;
+	int rule, dep, best, num, pos, i, s;
+	long score;
+	bool ok;
+
+	if((fin = fopen(dir, "r")) == NULL)
+		return false;
 
-	// mlist
-	mvlist_remove_all(&tmp);
-	pos = mvlist_first(mlist(bd));
-	while(pos != END)
+	while(fscanf(fin, "%d %d %ld %d %d", &rule, &dep, &score, &best, &num) == 5)
 	{
-		mvlist_insert_back(&tmp, ref_arr[pos]);
-		pos = mvlist_next(mlist(bd), pos);
-	}
-	mvlist_copy(&tmp, mlist(bd));
+		memset(used, 0, sizeof(used));
+		memset(sym, 0, sizeof(sym));
+		ok = num > 0 && num < 15 * 15 && dep > 0 && dep <= UCHAR_MAX;
 
-	// hlist
-	mvlist_remove_all(&tmp);
-	pos = mvlist_first(hlist(bd));
-	while(pos != END)
-	{
-		mvlist_insert_back(&tmp, ref_arr[pos]);
-		pos = mvlist_next(hlist(bd), pos);
+		for(i = 0; i < num; i++)
+		{
+			if(fscanf(fin, "%d", &pos) != 1)
+			{
+				fclose(fin);
+				return true;
+			}
+			if(pos < 0 || pos >= 15 * 15 || used[pos])
+				ok = false;
+			else
+			{
+				used[pos] = 1;
+				for(s = 0; s < SYM_NUM; s++)
+					sym[s] ^= Zobrist[i % 2 ? WHITE : BLACK][SymPos[s][pos]];
+			}
+		}
+		if(!ok || best < 0 || best >= 15 * 15 || used[best])
+			continue;
+
+		s = hash_canonical(sym);
+		key = book_key(sym[s]);
+
+		rec = book_record(col, key, INVALID, 0, 0, 0);
+		rec->rule = BOOK_RULE(rule != 0);
+		rec = book_record(col, key, SymPos[s][best], UCHAR_MAX, 0, 1);
+		rec->rule = BOOK_RULE(rule != 0);
+		rec->score = score;
+		rec->dep = dep;
 	}
-	mvlist_copy(&tmp, hlist(bd));
+
+	fclose(fin);
+	return true;
 }
 
-static void r0(board_t* bd)
+static int book_compare(const void* a, const void* b)
 {
-	;
+	const brec_t* x = (const brec_t*)a;
+	const brec_t* y = (const brec_t*)b;
+
+	if(x->key != y->key)
+		return x->key < y->key ? -1 : 1;
+	if(x->seq != y->seq)
+		return x->seq < y->seq ? -1 : 1;
+	return 0;
 }
 
-static void r0x(board_t* bd)
+/*
+ * Merge the trees of all books and the analysis file into one position table,
+ * a DAG of the book positions. Transpositions share a slot, a move found
+ * several times keeps its first place in book order and sums its statistics.
+ */
+static void book_build(tree_t** tree, const int num, const char* analysis, btable_t* tab)
 {
-	ref(bd);
+	bcollect_t col = { NULL, 0, 0 };
+	u64 sym[SYM_NUM] = { 0 };
+	u32 seen[15 * 15] = { 0 };
+	u32 where[15 * 15];
+	u32 i, j, k, freq, uniq = 0;
+	bmove_t* mv;
+	brec_t* rec;
+	u8 dist;
+	int b;
+
+	hash_init();
+	for(b = 0; b < num; b++)
+		if(tree[b] != NULL)
+			book_collect(&col, tree[b], 0, sym, 0, b, &freq, &dist);
+	book_collect_analysis(&col, analysis);
+	qsort(col.rec, col.num, sizeof(brec_t), book_compare);
+
+	for(i = 0; i < col.num; i++)
+		if(i == 0 || col.rec[i].key != col.rec[i - 1].key)
+			uniq++;
+
+	// keep the table at most half full
+	for(tab->size = 16; tab->size < 2 * uniq; tab->size *= 2)
+		;
+	tab->slot = (bslot_t*)calloc(tab->size, sizeof(bslot_t));
+	tab->move = (bmove_t*)malloc((col.num > 0 ? col.num : 1) * sizeof(bmove_t));
+	tab->moves = 0;
+
+	for(i = 0; i < col.num; i = j)
+	{
+		for(k = col.rec[i].key & (tab->size - 1); tab->slot[k].key; k = (k + 1) & (tab->size - 1))
+			;
+		tab->slot[k].key = col.rec[i].key;
+		tab->slot[k].move = tab->moves;
+
+		for(j = i; j < col.num && col.rec[j].key == col.rec[i].key; j++)
+		{
+			rec = &col.rec[j];
+			tab->slot[k].rule |= rec->rule;
+			if(rec->move == INVALID)
+				continue;
+
+			if(seen[rec->move] != i + 1)
+			{
+				seen[rec->move] = i + 1;
+				where[rec->move] = tab->moves;
+				mv = &tab->move[tab->moves++];
+				memset(mv, 0, sizeof(bmove_t));
+				mv->pos = rec->move;
+				mv->dist = rec->dist;
+			}
+			else
+				mv = &tab->move[where[rec->move]];
+
+			mv->books |= rec->books;
+			mv->freq += rec->freq;
+			mv->rule |= rec->rule;
+			if(rec->dist < mv->dist)
+				mv->dist = rec->dist;
+
+			// the deepest analysis wins
+			if(rec->dep > mv->dep)
+			{
+				mv->dep = rec->dep;
+				mv->score = rec->score;
+			}
+		}
+		tab->slot[k].num = tab->moves - tab->slot[k].move;
+	}
+
+	free(col.rec);
 }
 
-static void r90(board_t* bd)
+static void book_free(btable_t* tab)
 {
-	cc(bd);
+	free(tab->slot);
+	free(tab->move);
+	tab->slot = NULL;
+	tab->move = NULL;
+	tab->size = 0;
+	tab->moves = 0;
 }
 
-static void r90x(board_t* bd)
+// load every .lib book, a book that can't be loaded is left NULL
+static int book_load_all(tree_t** tree)
 {
-	cc(bd);
-	ref(bd);
+	int i, num = 0;
+
+	for(i = 0; i < BOOK_NUM; i++)
+	{
+		tree[i] = tree_init(1);
+		if(book_load(tree[i], i < DIRECT_NUM ? opening_d[i] : opening_id[i - DIRECT_NUM]))
+			num++;
+		else
+		{
+			tree_delete(tree[i]);
+			tree[i] = NULL;
+		}
+	}
+	return num;
 }
 
-static void r90xx(board_t* bd)
+static void book_delete_all(tree_t** tree)
 {
-	ref(bd);
-	cc(bd);
+	int i;
+
+	for(i = 0; i < BOOK_NUM; i++)
+		if(tree[i] != NULL)
+			tree_delete(tree[i]);
 }
 
-static void r180(board_t* bd)
+/*******************************************************************************
+							Compiled book functions
+*******************************************************************************/
+bool book_compile(const char* dir)
 {
-	cc(bd);
-	cc(bd);
+	tree_t* tree[BOOK_NUM];
+	bhead_t head;
+	btable_t tab = { NULL, 0, NULL, 0 };
+	FILE* fout;
+	bool ok;
+
+	// every book is required, the analysis isn't
+	ok = book_load_all(tree) == BOOK_NUM;
+	if(ok)
+		book_build(tree, BOOK_NUM, BOOK_ANALYSIS, &tab);
+	book_delete_all(tree);
+
+	memset(&head, 0, sizeof(head));
+	head.magic = BOOK_MAGIC;
+	head.version = BOOK_VERSION;
+	head.slots = tab.size;
+	head.moves = tab.moves;
+	head.books = BOOK_NUM;
+
+	if(ok && (fout = fopen(dir, "wb")) != NULL)
+	{
+		ok = fwrite(&head, sizeof(head), 1, fout) == 1
+		  && fwrite(tab.slot, sizeof(bslot_t), tab.size, fout) == tab.size
+		  && fwrite(tab.move, sizeof(bmove_t), tab.moves, fout) == tab.moves;
+		ok = fclose(fout) == 0 && ok;
+	}
+	else
+		ok = false;
+
+	book_free(&tab);
+	return ok;
 }
 
-static void r180x(board_t* bd)
+// return false if a compiled book could make lookups read out of bounds
+static bool book_check(const bhead_t* head, const size_t size)
 {
-	cc(bd);
-	cc(bd);
-	ref(bd);
+	const bslot_t* slot = (const bslot_t*)(head + 1);
+	const bmove_t* move = (const bmove_t*)(slot + head->slots);
+	u32 i;
+
+	if(size < sizeof(bhead_t) || head->magic != BOOK_MAGIC || head->version != BOOK_VERSION
+	|| head->slots == 0 || (head->slots & (head->slots - 1))
+	|| head->slots > (size - sizeof(bhead_t)) / sizeof(bslot_t)
+	|| head->moves > (size - sizeof(bhead_t) - head->slots * sizeof(bslot_t)) / sizeof(bmove_t))
+		return false;
+
+	for(i = 0; i < head->slots; i++)
+		if(slot[i].move > head->moves || slot[i].num > head->moves - slot[i].move)
+			return false;
+
+	for(i = 0; i < head->moves; i++)
+		if(move[i].pos >= 15 * 15)
+			return false;
+
+	return true;
 }
 
-static void r180xx(board_t* bd)
+bool book_verify(const char* dir)
 {
-	ref(bd);
-	cc(bd);
-	cc(bd);
+	const void* addr;
+	size_t size;
+	bool ok;
+
+	if(!map_file(dir, &addr, &size))
+		return false;
+	ok = book_check((const bhead_t*)addr, size);
+	unmap_file(addr, size);
+	return ok;
 }
 
-static void r270(board_t* bd)
+bool book_open(const char* dir)
 {
-	cc(bd);
-	cc(bd);
-	cc(bd);
+	tree_t* tree[BOOK_NUM];
+	const void* addr;
+	size_t size;
+
+	if(Slot != NULL)
+		return true;
+	hash_init();
+
+	if(map_file(dir, &addr, &size))
+	{
+		if(book_check((const bhead_t*)addr, size))
+		{
+			Flat = (const bhead_t*)addr;
+			FlatSize = size;
+			Slot = (const bslot_t*)(Flat + 1);
+			Mask = Flat->slots - 1;
+			Move = (const bmove_t*)(Slot + Flat->slots);
+			return true;
+		}
+		unmap_file(addr, size);
+	}
+
+	// merge the .lib books found and the analysis, once for the whole run
+	book_load_all(tree);
+	book_build(tree, BOOK_NUM, BOOK_ANALYSIS, &Built);
+	if(Built.moves > 0)
+	{
+		Slot = Built.slot;
+		Mask = Built.size - 1;
+		Move = Built.move;
+	}
+	else
+		book_free(&Built);
+	book_delete_all(tree);
+	return Slot != NULL;
 }
 
-static void r270x(board_t* bd)
+void book_close()
 {
-	cc(bd);
-	cc(bd);
-	cc(bd);
-	ref(bd);
+	if(Flat != NULL)
+		unmap_file(Flat, FlatSize);
+	book_free(&Built);
+	Flat = NULL;
+	FlatSize = 0;
+	Slot = NULL;
+	Mask = 0;
+	Move = NULL;
 }
 
-static void r270xx(board_t* bd)
+bool book_isload()
 {
-	ref(bd);
-	cc(bd);
-	cc(bd);
-	cc(bd);
+	return Slot != NULL;
 }
 
-static void (*trans[TRANS_NUM])(board_t* bd) = {
-	r0, r0x, r90, r90x, r180, r180x, r270, r270x
-};
-
-static void (*ctrans[TRANS_NUM])(board_t* bd) = {
-	r0, r0x, r270, r270xx, r180, r180xx, r90, r90xx
-};
+size_t book_memory()
+{
+	return FlatSize + (size_t)Built.size * sizeof(bslot_t) + (size_t)Built.moves * sizeof(bmove_t);
+}
 
 /*******************************************************************************
-								Tree Search functions
+							Book lookup functions
 *******************************************************************************/
-// variable saving the former board transform index
-static int TransIndex = 0;
-
-/*
- * Preorder traverse the optree for the current mvlist key. Generate hlist(bd).
- * Cannot solve permutation situation with the undown move.
- */
-static void book_generate_dfs(board_t* bd)
+static const bslot_t* book_probe(const u64 key)
 {
-	key_t key;
-	mvlist_remove_all(hlist(bd));
-	key_gen_mvlist(&key, mstk(bd));
-	tree_find_key(optree, &key, bd->num, bd);
+	u32 i;
+
+	for(i = key & Mask; Slot[i].key; i = (i + 1) & Mask)
+		if(Slot[i].key == key)
+			return &Slot[i];
+	return NULL;
 }
 
 /*
- * Preorder traverse the optree for every possible mvlist key. Generate hlist(bd).
- * Can solve permutation situation with the undone move.
+ * Put the successors of slot good for the side to move into hlist(bd), one
+ * chosen by frequency first. The .lib lines are black wins, so their white
+ * moves are left out.
  */
-static void book_generate_permutation(board_t* bd)
+static void book_successors(board_t* bd, const bslot_t* slot, const int s)
 {
-	key_t key;
-	mvlist_t tmplist;
-	mvlist_reset(&tmplist);
+	const bmove_t* mv;
+	u8 pos[15 * 15];
+	u32 freq[15 * 15];
+	u32 total = 0, r;
+	int i, num = 0, pick = 0;
 
-	u8 pos = mvlist_first(mlist(bd));
-	while(pos != END)
+	for(i = 0; i < slot->num; i++)
 	{
-		mvlist_insert_back(mstk(bd), pos);
-		key_gen_mvlist(&key, mstk(bd));
-		mvlist_remove_back(mstk(bd));
+		mv = &Move[slot->move + i];
+		if(!(mv->rule & BOOK_RULE(isForbidden)) || (bd->num % 2 && mv->dep == 0))
+			continue;
+
+		pos[num] = SymPos[SymInv[s]][mv->pos];
+		freq[num] = mv->freq;
+		if(bd->arr[pos[num]] == EMPTY)
+			total += freq[num++];
+	}
+	if(num == 0)
+		return;
 
-		if(tree_find_key(optree, &key, bd->num, bd))
-			mvlist_insert_back(&tmplist, pos);
+	r = (u32)((double)rand() / ((double)RAND_MAX + 1) * total);
+	for(pick = 0; pick < num - 1 && r >= freq[pick]; pick++)
+		r -= freq[pick];
 
-		pos = mvlist_next(mlist(bd), pos);
-	}
+	mvlist_insert_back(hlist(bd), pos[pick]);
+	for(i = 0; i < num; i++)
+		if(i != pick)
+			mvlist_insert_back(hlist(bd), pos[i]);
+}
+
+bool book_lookup(board_t* bd)
+{
+	const bslot_t* slot;
+	int s;
 
 	mvlist_remove_all(hlist(bd));
-	mvlist_copy(&tmplist, hlist(bd));
+	if(Slot == NULL)
+		return false;
+
+	if((slot = book_probe(book_key(board_hash(bd, &s)))) != NULL)
+		book_successors(bd, slot, s);
+	return mvlist_size(hlist(bd)) > 0;
 }
 
 /*
- * Preorder traverse the optree. Generate hlist(bd).
- * Rotation and reflection are not considered.
+ * Without successors, the moves leading into a book position are used, which
+ * covers the opponent playing a book move earlier than the book does.
  */
-static void book_generate_no_trans(board_t* bd)
-{
-	book_generate_dfs(bd);
-	if(!mvlist_size(hlist(bd)) && bd->num <= MAX_DFS_DEP)
-		book_generate_permutation(bd);
-}
-
 bool book_generate(board_t* bd)
 {
-	int i;
+	u64 next[SYM_NUM];
+	const bslot_t* slot;
+	u8 color = bd->num % 2 ? WHITE : BLACK;
+	u8 pos;
+	int s;
 
-	(*trans[TransIndex])(bd);
-	book_generate_no_trans(bd);
-	(*ctrans[TransIndex])(bd);
+	if(book_lookup(bd) || Slot == NULL)
+		return mvlist_size(hlist(bd)) > 0;
 
-	if(!mvlist_size(hlist(bd)))
+	if(bd->num <= MAX_DFS_DEP)
 	{
-		for(i = 0; i < TRANS_NUM; i++)
+		for(pos = mvlist_first(mlist(bd)); pos != END; pos = mvlist_next(mlist(bd), pos))
 		{
-			(*trans[i])(bd);
-			book_generate_no_trans(bd);
-			(*ctrans[i])(bd);
-
-			if(mvlist_size(hlist(bd)))
-			{
-				TransIndex = i;
-				break;
-			}
+			for(s = 0; s < SYM_NUM; s++)
+				next[s] = bd->sym[s] ^ Zobrist[color][SymPos[s][pos]];
+			s = hash_canonical(next);
+			slot = book_probe(book_key(next[s]));
+			if(slot != NULL && (slot->rule & BOOK_RULE(isForbidden)))
+				mvlist_insert_back(hlist(bd), pos);
 		}
 	}
 
-	if(mvlist_size(hlist(bd)))
-		return true;
-	else
-		return false;
+	return mvlist_size(hlist(bd)) > 0;
 }
-
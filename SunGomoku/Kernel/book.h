@@ -18,31 +18,60 @@ extern "C" {
 #include "macro.h"
 #include "board.h"
 
+// compiled book opened at startup
+#define BOOK_FILE		"opening/book.bin"
+
+// positions analyzed by sgbookgen, merged with the .lib books if present
+#define BOOK_ANALYSIS	"opening/analysis.txt"
+
 /*
- * Initialize optree from a randomly chosen opening book.
+ * Merge all direct and indirect .lib books and the analysis into one compiled
+ * book file dir.
+ * Return false if a book can't be read or the file can't be written.
  */
-void book_choose_direct();
-void book_choose_indirect();
+bool book_compile(const char* dir);
 
 /*
- * Return true if book is loaded. Or return false.
+ * Return true if the compiled book file dir passes the checks of
+ * book_open(). Unlike book_open(), nothing else is loaded if it fails.
  */
-bool book_isload();
+bool book_verify(const char* dir);
 
 /*
- * Reset optree.
+ * Open the book shared by all threads until book_close(). Map the compiled
+ * book dir, or merge the .lib books and the analysis if it is missing or
+ * broken.
+ * Return false if no book is found.
  */
-void book_reset();
+bool book_open(const char* dir);
 
 /*
- * Delete optree.
+ * Close the book.
  */
-void book_delete();
+void book_close();
+
+/*
+ * Return true if book is open. Or return false.
+ */
+bool book_isload();
 
 /*
- * Generate hlist using opening book.
+ * Return the bytes taken by the open book, merged or mapped.
+ */
+size_t book_memory();
+
+/*
+ * Generate hlist from the book moves of the position for the current rule,
+ * in any orientation of the board. White only gets analyzed moves.
+ * The first move is chosen at random, weighted by the # of book lines.
  * Return true if find moves in the book. Or return false.
  */
+bool book_lookup(board_t* bd);
+
+/*
+ * Same as book_lookup(), but without book moves fall back to the moves
+ * leading into a book position.
+ */
 bool book_generate(board_t* bd);
 
 #ifdef  __cplusplus
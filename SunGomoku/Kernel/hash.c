@@ -0,0 +1,89 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * hash.c - Zobrist keys and board symmetries
+ */
+
+#include "hash.h"
+#include "macro.h"
+
+#define HASH_SEED	0x5347424b31393031ULL
+
+u64 Zobrist[3][15 * 15];
+u8 SymPos[SYM_NUM][15 * 15];
+u8 SymInv[SYM_NUM];
+
+static bool HashReady = false;
+
+// splitmix64, the keys must be the same on every platform
+static u64 hash_next(u64* state)
+{
+	u64 z = (*state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+void hash_init()
+{
+	u64 state = HASH_SEED;
+	int i, j, s, r, c, t;
+
+	if(HashReady)
+		return;
+
+	for(i = 0; i < 15 * 15; i++)
+	{
+		Zobrist[EMPTY][i] = 0;
+		Zobrist[BLACK][i] = hash_next(&state);
+		Zobrist[WHITE][i] = hash_next(&state);
+	}
+
+	for(s = 0; s < SYM_NUM; s++)
+	{
+		for(i = 0; i < 15 * 15; i++)
+		{
+			r = i / 15;
+			c = i % 15;
+			if(s & 1)
+				c = 14 - c;
+			if(s & 2)
+				r = 14 - r;
+			if(s & 4)
+			{
+				t = r;
+				r = c;
+				c = t;
+			}
+			SymPos[s][i] = r * 15 + c;
+		}
+	}
+
+	for(s = 0; s < SYM_NUM; s++)
+	{
+		for(t = 0; t < SYM_NUM; t++)
+		{
+			for(j = 0; j < 15 * 15; j++)
+				if(SymPos[t][SymPos[s][j]] != j)
+					break;
+			if(j == 15 * 15)
+				SymInv[s] = t;
+		}
+	}
+
+	HashReady = true;
+}
+
+int hash_canonical(const u64* sym)
+{
+	int s, best = 0;
+
+	for(s = 1; s < SYM_NUM; s++)
+		if(sym[s] < sym[best])
+			best = s;
+	return best;
+}
@@ -0,0 +1,50 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * hash.h - Zobrist keys and board symmetries
+ *
+ * Notice: The compiled opening book and the learned positions store these
+ * keys. Bump BOOK_VERSION in book.c and TT_VERSION in ttable.c if they change.
+ */
+
+#ifndef __HASH_H__
+#define __HASH_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include "macro.h"
+
+#define SYM_NUM		8
+
+// Zobrist key of a BLACK or WHITE disc on a position
+extern u64 Zobrist[3][15 * 15];
+
+// position under symmetry i, bit 0 mirrors columns, bit 1 mirrors rows and
+// bit 2 then swaps rows and columns
+extern u8 SymPos[SYM_NUM][15 * 15];
+
+// inverse of symmetry i
+extern u8 SymInv[SYM_NUM];
+
+/*
+ * Generate the Zobrist keys and symmetry tables. Safe to call again.
+ */
+void hash_init();
+
+/*
+ * Return the symmetry whose hash is the smallest of the SYM_NUM hashes of
+ * one position, the lowest one on ties. That hash is the canonical one.
+ */
+int hash_canonical(const u64* sym);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
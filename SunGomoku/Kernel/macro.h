@@ -49,6 +49,13 @@ typedef	uint16_t	u16;
 typedef	uint32_t	u32;
 typedef	uint64_t	u64;
 
+// storage class for state owned by the calling thread (one engine per thread)
+#if defined(_MSC_VER)
+#define THREAD_LOCAL		__declspec(thread)
+#else
+#define THREAD_LOCAL		__thread
+#endif
+
 #ifdef  __cplusplus
 }
 #endif
@@ -0,0 +1,84 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * mapfile.c - read only memory mapped files
+ */
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "mapfile.h"
+#include "macro.h"
+
+bool map_file(const char* dir, const void** addr, size_t* size)
+{
+#ifdef _WIN32
+	HANDLE file, mapping;
+	LARGE_INTEGER len;
+	void* view = NULL;
+
+	file = CreateFileA(dir, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE)
+		return false;
+
+	if(GetFileSizeEx(file, &len) && len.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(mapping != NULL)
+		{
+			view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping);		// the view keeps the mapping alive
+		}
+	}
+	CloseHandle(file);
+
+	if(view == NULL)
+		return false;
+	*addr = view;
+	*size = (size_t)len.QuadPart;
+	return true;
+#else
+	struct stat st;
+	void* view;
+	int fd;
+
+	if((fd = open(dir, O_RDONLY)) < 0)
+		return false;
+
+	if(fstat(fd, &st) < 0 || st.st_size <= 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	view = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);			// the mapping keeps the file alive
+
+	if(view == MAP_FAILED)
+		return false;
+	*addr = view;
+	*size = st.st_size;
+	return true;
+#endif
+}
+
+void unmap_file(const void* addr, const size_t size)
+{
+#ifdef _WIN32
+	(void)size;
+	UnmapViewOfFile(addr);
+#else
+	munmap((void*)addr, size);
+#endif
+}
@@ -0,0 +1,35 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * mapfile.h - read only memory mapped files
+ */
+
+#ifndef __MAPFILE_H__
+#define __MAPFILE_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include "macro.h"
+
+/*
+ * Map the whole file dir read only. Set addr and size of the mapping.
+ * Return false if the file can't be opened, is empty or can't be mapped.
+ */
+bool map_file(const char* dir, const void** addr, size_t* size);
+
+/*
+ * Unmap a mapping returned by map_file().
+ */
+void unmap_file(const void* addr, const size_t size);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
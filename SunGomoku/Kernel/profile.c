@@ -0,0 +1,242 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * profile.c - named search_t profiles
+ */
+
+#include <ctype.h>
+
+#include "profile.h"
+#include "macro.h"
+#include "search.h"
+
+#define BUILTIN_NUM		6
+#define LINE_SIZE		256
+
+// default score constants
+#define SCORE_DEFAULT {		\
+	.win = WIN,				\
+	.lose = LOSE,			\
+	.free4 = 4320,			\
+	.dead4 = 882,			\
+	.free3 = 630,			\
+	.dead3 = 294,			\
+	.free2 = 210,			\
+	.dead2 = 42,			\
+	.free1 = 30,			\
+	.dead1 = 1,				\
+	.free3a = 693,			\
+	.free2a = 231,			\
+	.free1a = 33			\
+}
+
+#define PROFILE(n, d, b, q) {	\
+	.name = n,				\
+	.srh = {				\
+		.sc = SCORE_DEFAULT,\
+		.me = BLACK,		\
+		.opp = WHITE,		\
+		.leaf = 10,			\
+		.dep = d,			\
+		.presrh = true,		\
+		.book = b,			\
+		.adapt = true,		\
+		.reduce = true,		\
+		.extend = true,		\
+		.quiesce = q,		\
+		.nodes = 0,			\
+		.time = 0,			\
+		.memory = 0,		\
+		.left = 0,			\
+		.inc = 0			\
+	}						\
+}
+
+// built-in profiles, the first three for forbidden rule and the rest for free
+// rule, in the order of set_difficulty(). The quiescence search helps the
+// shallow ones most but triples the time of the hard one.
+static profile_t Profile[PROFILE_MAX] = {
+	PROFILE("novice",		4,	false,	true),
+	PROFILE("normal",		8,	false,	true),
+	PROFILE("hard",			10,	true,	false),
+	PROFILE("free-novice",	1,	false,	true),
+	PROFILE("free-normal",	2,	false,	true),
+	PROFILE("free-hard",	4,	false,	true)
+};
+
+static int ProfileNum = BUILTIN_NUM;
+
+bool profile_set(search_t* srh, const char* key, const long val)
+{
+	if(!strcmp(key, "dep"))
+		srh->dep = val;
+	else if(!strcmp(key, "leaf"))
+		srh->leaf = val;
+	else if(!strcmp(key, "presrh"))
+		srh->presrh = val;
+	else if(!strcmp(key, "book"))
+		srh->book = val;
+	else if(!strcmp(key, "adapt"))
+		srh->adapt = val;
+	else if(!strcmp(key, "reduce"))
+		srh->reduce = val;
+	else if(!strcmp(key, "extend"))
+		srh->extend = val;
+	else if(!strcmp(key, "quiesce"))
+		srh->quiesce = val;
+	else if(!strcmp(key, "nodes"))
+		srh->nodes = val < 0 ? 0 : val;
+	else if(!strcmp(key, "time"))
+		srh->time = val < 0 ? 0 : val;
+	else if(!strcmp(key, "memory"))
+		srh->memory = val < 0 ? 0 : val;
+	else if(!strcmp(key, "free4"))
+		srh->sc.free4 = val;
+	else if(!strcmp(key, "dead4"))
+		srh->sc.dead4 = val;
+	else if(!strcmp(key, "free3"))
+		srh->sc.free3 = val;
+	else if(!strcmp(key, "dead3"))
+		srh->sc.dead3 = val;
+	else if(!strcmp(key, "free2"))
+		srh->sc.free2 = val;
+	else if(!strcmp(key, "dead2"))
+		srh->sc.dead2 = val;
+	else if(!strcmp(key, "free1"))
+		srh->sc.free1 = val;
+	else if(!strcmp(key, "dead1"))
+		srh->sc.dead1 = val;
+	else if(!strcmp(key, "free3a"))
+		srh->sc.free3a = val;
+	else if(!strcmp(key, "free2a"))
+		srh->sc.free2a = val;
+	else if(!strcmp(key, "free1a"))
+		srh->sc.free1a = val;
+	else
+		return false;
+	return true;
+}
+
+// remove leading and trailing blanks
+static char* trim(char* str)
+{
+	char* end;
+
+	while(isspace((unsigned char)*str))
+		str++;
+	end = str + strlen(str);
+	while(end > str && isspace((unsigned char)end[-1]))
+		end--;
+	*end = '\0';
+
+	return str;
+}
+
+// return the slot of the profile with the name, add one if not found
+static profile_t* profile_slot(const char* name)
+{
+	int i;
+
+	for(i = 0; i < ProfileNum; i++)
+		if(!strcmp(Profile[i].name, name))
+			break;
+
+	if(i == ProfileNum)
+	{
+		if(ProfileNum == PROFILE_MAX)
+			return NULL;
+		ProfileNum++;
+	}
+
+	// start from the built-in hard profile
+	Profile[i].srh = Profile[2].srh;
+	strncpy(Profile[i].name, name, PROFILE_NAME - 1);
+	Profile[i].name[PROFILE_NAME - 1] = '\0';
+
+	return &Profile[i];
+}
+
+bool profile_load(const char* dir)
+{
+	static profile_t saved[PROFILE_MAX];
+	int savedNum = ProfileNum;
+	FILE* fin;
+	char buf[LINE_SIZE], *line, *eq, *end;
+	profile_t* cur = NULL;
+	int row = 0;
+	long val;
+
+	if((fin = fopen(dir, "r")) == NULL)
+		return false;
+
+	// the file applies as a whole or not at all
+	memcpy(saved, Profile, sizeof(Profile));
+
+	while(fgets(buf, LINE_SIZE, fin) != NULL)
+	{
+		row++;
+		if((line = strchr(buf, '#')) != NULL)
+			*line = '\0';
+		line = trim(buf);
+
+		if(*line == '\0')
+			continue;
+
+		// section header
+		if(*line == '[')
+		{
+			if((end = strchr(line, ']')) == NULL)
+				break;
+			*end = '\0';
+			if((cur = profile_slot(trim(line + 1))) == NULL)
+				break;
+			continue;
+		}
+
+		// key = value
+		if(cur == NULL || (eq = strchr(line, '=')) == NULL)
+			break;
+		*eq = '\0';
+		val = strtol(eq + 1, &end, 10);
+		if(end == eq + 1 || *trim(end) != '\0' || !profile_set(&cur->srh, trim(line), val))
+			break;
+	}
+
+	if(!feof(fin))
+	{
+		fprintf(stderr, "profile error in %s at line %d\n", dir, row);
+		memcpy(Profile, saved, sizeof(Profile));
+		ProfileNum = savedNum;
+		fclose(fin);
+		return false;
+	}
+
+	fclose(fin);
+	return true;
+}
+
+const profile_t* profile_find(const char* name)
+{
+	int i;
+	for(i = 0; i < ProfileNum; i++)
+		if(!strcmp(Profile[i].name, name))
+			return &Profile[i];
+	return NULL;
+}
+
+int profile_num()
+{
+	return ProfileNum;
+}
+
+const profile_t* profile_get(const int i)
+{
+	if(i < 0 || i >= ProfileNum)
+		return NULL;
+	return &Profile[i];
+}
+
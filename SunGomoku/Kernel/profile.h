@@ -0,0 +1,77 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * profile.h - named search_t profiles
+ *
+ * Profile file format, one profile per section, '#' starts a comment:
+ *
+ *	[fast]
+ *	dep = 6
+ *	leaf = 8
+ *	book = 0
+ *	free3 = 600
+ *
+ * Keys are dep, leaf, presrh, book, adapt, reduce, extend, quiesce, the limits
+ * nodes, time (milliseconds) and memory (megabytes), and the score_t member
+ * names.
+ * Missing keys keep the values of the built-in "hard" profile.
+ */
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include "macro.h"
+#include "search.h"
+
+#define PROFILE_MAX		32		// maximum # of profiles
+#define PROFILE_NAME	32		// maximum profile name length
+
+// profile structure
+typedef struct {
+	char name[PROFILE_NAME];	// profile name
+	search_t srh;				// search constants
+} profile_t;
+
+/*
+ * Load profiles from a file. A profile replaces the one with the same name.
+ * Loading stops at the first bad line, which is reported on stderr, and
+ * leaves all profiles as they were.
+ * Return false if the file can't be opened or has an error.
+ */
+bool profile_load(const char* dir);
+
+/*
+ * Return the profile with the name or NULL if no such profile.
+ */
+const profile_t* profile_find(const char* name);
+
+/*
+ * Return the number of profiles.
+ */
+int profile_num();
+
+/*
+ * Return the i-th profile. The built-in profiles come first.
+ */
+const profile_t* profile_get(const int i);
+
+/*
+ * Set a search_t member by its profile key.
+ * Return false if the key is unknown.
+ */
+bool profile_set(search_t* srh, const char* key, const long val);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
+
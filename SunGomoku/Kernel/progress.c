@@ -0,0 +1,52 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * progress.c - search progress snapshots and a lock-free channel for them
+ */
+
+#include "progress.h"
+#include "macro.h"
+#include "thread.h"
+
+void channel_reset(channel_t* ch)
+{
+	ch->head = 0;
+	ch->tail = 0;
+}
+
+bool channel_push(channel_t* ch, const progress_t* info)
+{
+	u32 head = ch->head;
+
+	if(head - ch->tail == CHANNEL_SIZE)
+		return false;
+
+	ch->slot[head & (CHANNEL_SIZE - 1)] = *info;
+
+	// the slot must be visible before the new head
+	memory_barrier();
+	ch->head = head + 1;
+	return true;
+}
+
+bool channel_pop(channel_t* ch, progress_t* info)
+{
+	u32 tail = ch->tail;
+
+	if(tail == ch->head)
+		return false;
+
+	// the slot is read after the head that covers it
+	memory_barrier();
+	*info = ch->slot[tail & (CHANNEL_SIZE - 1)];
+
+	// and before the slot is handed back
+	memory_barrier();
+	ch->tail = tail + 1;
+	return true;
+}
+
@@ -0,0 +1,68 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * progress.h - search progress snapshots and a lock-free channel for them
+ *
+ * The channel is a ring buffer with one producer (the search thread) and one
+ * consumer (the ui thread). Neither side ever waits, the producer drops a
+ * snapshot when the buffer is full.
+ */
+
+#ifndef __PROGRESS_H__
+#define __PROGRESS_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include "macro.h"
+
+#define PV_MAX			32		// maximum principal variation length
+#define CHANNEL_SIZE	16		// # of snapshots buffered, a power of two
+
+// search progress snapshot
+typedef struct {
+	u8 dep;					// nominal depth being searched
+	u8 best;				// best root move so far, INVALID if none yet
+	long score;				// score of best for the side to move
+	u8 pvlen;				// principal variation length
+	u8 pv[PV_MAX];			// principal variation starting with best
+	u64 nodes;				// # of nodes so far
+	u32 nps;				// nodes per second
+	double time;			// seconds since the search started
+} progress_t;
+
+// single-producer single-consumer channel
+typedef struct {
+	progress_t slot[CHANNEL_SIZE];
+	volatile u32 head;		// # of snapshots pushed, written by the producer
+	volatile u32 tail;		// # of snapshots popped, written by the consumer
+} channel_t;
+
+/*
+ * Empty a channel. Neither side may use it meanwhile.
+ */
+void channel_reset(channel_t* ch);
+
+/*
+ * Push a snapshot, producer side.
+ * Return false if the channel is full and the snapshot is dropped.
+ */
+bool channel_push(channel_t* ch, const progress_t* info);
+
+/*
+ * Pop the oldest snapshot, consumer side.
+ * Return false if the channel is empty.
+ */
+bool channel_pop(channel_t* ch, progress_t* info);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
+
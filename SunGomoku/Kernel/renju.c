@@ -0,0 +1,151 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * renju.c - exact renju forbidden point detection
+ */
+
+#include "renju.h"
+#include "macro.h"
+
+// row and column steps of the four directions
+static const int DR[4] = { 0, 1, 1,  1 };
+static const int DC[4] = { 1, 0, 1, -1 };
+
+/*******************************************************************************
+								Line helpers
+*******************************************************************************/
+// return the cell k steps from pos in direction d, or -1 off the board
+static inline int cell(const int pos, const int d, const int k)
+{
+	int r = pos / 15 + k * DR[d];
+	int c = pos % 15 + k * DC[d];
+
+	if(r < 0 || r >= 15 || c < 0 || c >= 15)
+		return -1;
+	return r * 15 + c;
+}
+
+// length of the black run through pos in direction d
+static int run(const u8* arr, const int pos, const int d)
+{
+	int n = 1, k, p;
+
+	for(k = 1; (p = cell(pos, d, k)) >= 0 && arr[p] == BLACK; k++)
+		n++;
+	for(k = -1; (p = cell(pos, d, k)) >= 0 && arr[p] == BLACK; k--)
+		n++;
+	return n;
+}
+
+// fill ks with the steps of the empty cells making an exact five with pos in
+// direction d and return their number
+static int five_cells(u8* arr, const int pos, const int d, int* ks)
+{
+	int k, p, n = 0;
+
+	for(k = -4; k <= 4; k++)
+	{
+		p = cell(pos, d, k);
+		if(k == 0 || p < 0 || arr[p] != EMPTY)
+			continue;
+		arr[p] = BLACK;
+		if(run(arr, pos, d) == 5)
+			ks[n++] = k;
+		arr[p] = EMPTY;
+	}
+	return n;
+}
+
+// # of fours through pos in direction d, a straight four counts once
+static int four_count(u8* arr, const int pos, const int d)
+{
+	int ks[8];
+	int n = five_cells(arr, pos, d, ks);
+
+	if(n == 2 && ks[1] - ks[0] == 5)
+		return 1;
+	return n;
+}
+
+// return true if pos is in a straight four in direction d
+static bool straight_four(u8* arr, const int pos, const int d)
+{
+	int ks[8];
+	int n = five_cells(arr, pos, d, ks);
+
+	return n == 2 && ks[1] - ks[0] == 5;
+}
+
+static bool forbidden(u8* arr, const int pos);
+
+// return true if pos is in a real three in direction d, a move making it a
+// straight four must not be forbidden
+static bool three(u8* arr, const int pos, const int d)
+{
+	int k, p;
+	bool is;
+
+	for(k = -4; k <= 4; k++)
+	{
+		p = cell(pos, d, k);
+		if(k == 0 || p < 0 || arr[p] != EMPTY)
+			continue;
+		arr[p] = BLACK;
+		is = straight_four(arr, pos, d) && !forbidden(arr, p);
+		arr[p] = EMPTY;
+		if(is)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Return true if the black disc on pos is forbidden, directions with a four
+ * are not searched for threes.
+ */
+static bool forbidden(u8* arr, const int pos)
+{
+	int d, fours = 0, threes = 0, four[4];
+
+	// a five wins even with an overline on another line
+	for(d = 0; d < 4; d++)
+		if(run(arr, pos, d) == 5)
+			return false;
+
+	for(d = 0; d < 4; d++)
+	{
+		if(run(arr, pos, d) > 5)
+			return true;
+		four[d] = four_count(arr, pos, d);
+		fours += four[d];
+	}
+	if(fours > 1)
+		return true;
+
+	for(d = 0; d < 4; d++)
+		if(!four[d] && three(arr, pos, d) && ++threes > 1)
+			return true;
+	return false;
+}
+
+/*******************************************************************************
+								Interface
+*******************************************************************************/
+bool renju_check(u8* arr, const u8 pos)
+{
+	bool is;
+
+	arr[pos] = BLACK;
+	is = forbidden(arr, pos);
+	arr[pos] = EMPTY;
+	return is;
+}
+
+bool renju_check_disc(u8* arr, const u8 pos)
+{
+	return forbidden(arr, pos);
+}
@@ -0,0 +1,44 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * renju.h - exact renju forbidden point detection
+ *
+ * A black move is forbidden if it makes no five and makes an overline, two
+ * fours or two real free threes. A free three is real only if some move
+ * turning it into a straight four is not forbidden itself, which is checked
+ * recursively.
+ *
+ * board_forbidden() finds the candidates from the shape codes of board_t and
+ * calls this module only for two threes.
+ */
+
+#ifndef __RENJU_H__
+#define __RENJU_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include "macro.h"
+
+/*
+ * Return true if black can't move on pos of arr under the renju rule.
+ * arr[pos] must be EMPTY, it is changed during the call and then restored.
+ */
+bool renju_check(u8* arr, const u8 pos);
+
+/*
+ * Return true if the black disc on pos of arr is on a forbidden point.
+ */
+bool renju_check_disc(u8* arr, const u8 pos);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
+
@@ -10,11 +10,58 @@
 
 #include "search.h"
 #include "macro.h"
+#include "thread.h"
 #include "board.h"
 #include "book.h"
+#include "progress.h"
+#include "ttable.h"
+#include "timeman.h"
+
+#define LEAF_MIN	4		// minimum leaf size of adaptive generation
+#define LMR_DEP		4		// minimum remaining depth of late move reduction
+#define LMR_MOVES	3		// # of moves searched to full depth before reducing
+#define QS_DEP		8		// maximum plies of fours and blocks beyond the horizon
+#define TICK_MASK	1023	// progress and limits are checked once per 1024 nodes
+#define PROGRESS_GAP	0.1	// minimum seconds between progress snapshots
+#define EVAL_BITS	15		// the evaluation cache has 2^EVAL_BITS entries,
+								// 512 KB of every thread that searches
 
 extern bool isForbidden;
-static bool BookInUse = false;	// set if the opening book is in use.
+static THREAD_LOCAL u64 Nodes = 0;			// # of nodes of the last search
+static THREAD_LOCAL long Score = 0;			// root score of the last search
+static THREAD_LOCAL u8 RootNum = 0;			// # of discs at the root
+static volatile bool Abort = false;			// shared by all threads
+static THREAD_LOCAL bool Stop = false;		// set when a limit of the search is hit
+
+// principal variation, Pv[ply] is the best line found below the node at ply
+static THREAD_LOCAL u8 Pv[PV_MAX][PV_MAX];
+static THREAD_LOCAL u8 PvLen[PV_MAX];
+
+// evaluation cache entry, valid in the search of its age
+typedef struct {
+	u64 key;
+	int32_t score;
+	u32 age;
+} eval_t;
+
+// lossy evaluation cache of this thread, the newest score wins a slot
+static THREAD_LOCAL eval_t EvalTab[1 << EVAL_BITS];
+static THREAD_LOCAL u32 EvalAge = 0;
+static THREAD_LOCAL u64 EvalProbes = 0;
+static THREAD_LOCAL u64 EvalHits = 0;
+
+// transposition table of the searches on this thread, keys are salted with
+// the rule and the search constants shaping the tree, so only searches of
+// the same profile and depth share entries
+static THREAD_LOCAL ttable_t* Table = NULL;
+static THREAD_LOCAL u64 Salt = 0;
+
+// progress reporting of the search on this thread
+static THREAD_LOCAL channel_t* Chan = NULL;
+static THREAD_LOCAL progress_t Info;		// snapshot being built
+static THREAD_LOCAL double StartTime;
+static THREAD_LOCAL double LastTime;
+static THREAD_LOCAL double TimeLimit;		// seconds of the search, 0 for none
 
 /*******************************************************************************
 							Helper variable and functions
@@ -22,6 +69,7 @@ static bool BookInUse = false;	// set if the opening book is in use.
 // pos-key pair structure
 typedef struct {
 	u8 pos;
+	bool force;		// set if the move makes a four or a free three
 	long key;
 } pair_t;
 
@@ -72,12 +120,9 @@ static void pair_sort(pair_t* arr, u8 N)
 		{
 			if(less(&arr[j], &arr[j + 1]))
 			{
-				tmp.pos = arr[j].pos;
-				tmp.key = arr[j].key;
-				arr[j].pos = arr[j + 1].pos;
-				arr[j].key = arr[j + 1].key;
-				arr[j + 1].pos = tmp.pos;
-				arr[j + 1].key = tmp.key;
+				tmp = arr[j];
+				arr[j] = arr[j + 1];
+				arr[j + 1] = tmp;
 			}
 			else
 				break;
@@ -88,7 +133,18 @@ static void pair_sort(pair_t* arr, u8 N)
 /*******************************************************************************
 								Heuristic functions
 *******************************************************************************/
-long evaluate(const board_t* bd, const score_t* sc, const u8 color)
+// key of the evaluation of bd for color, the last move matters to
+// board_gameover() only with forbidden points
+static inline u64 eval_key(const board_t* bd, const u8 color)
+{
+	u64 key = bd->sym[0];
+
+	if(isForbidden && bd->num > 0)
+		key ^= (mvlist_last(mstk(bd)) + 1) * 0x9e3779b97f4a7c15ULL;
+	return color == WHITE ? ~key : key;
+}
+
+static long evaluate_board(const board_t* bd, const score_t* sc, const u8 color)
 {
 	long score = 0;
 	u8 win = board_gameover(bd);
@@ -146,8 +202,36 @@ long evaluate(const board_t* bd, const score_t* sc, const u8 color)
 	return INVALID;
 }
 
+long evaluate(const board_t* bd, const score_t* sc, const u8 color)
+{
+	u64 key = eval_key(bd, color);
+	eval_t* ent = &EvalTab[key & ((1 << EVAL_BITS) - 1)];
+
+	EvalProbes++;
+	if(ent->key == key && ent->age == EvalAge)
+	{
+		EvalHits++;
+		return ent->score;
+	}
+
+	ent->key = key;
+	ent->age = EvalAge;
+	ent->score = evaluate_board(bd, sc, color);
+	return ent->score;
+}
+
+// return true if color makes a five by moving on pos, an overline of black
+// only without forbidden points
+static inline bool makes_five(const board_t* bd, const u8 pos, const u8 color)
+{
+	return board_shape(bd, pos, color, 0) == FIVE || board_shape(bd, pos, color, 1) == FIVE
+		|| board_shape(bd, pos, color, 2) == FIVE || board_shape(bd, pos, color, 3) == FIVE;
+}
+
 /*
  * Generate must-do moves in hlist(bd).
+ * Fives come from the shape codes, and only the cells board_window() finds
+ * on the threats are tried for the defences.
  *
  * @param [out]	bd		The hlist member of bd is changed.
  * @param [in]	me		My color.
@@ -164,42 +248,11 @@ static bool must_do_generate(board_t* bd, const u8 me, const u8 opp)
 		pos = mvlist_first(mlist(bd));
 		while(pos != END)
 		{
-			do_move_no_mvlist(bd, pos, me);
-			
-			if(isForbidden)
-			{
-				if(me == BLACK)
-				{
-					if(pattern_read(hpinc(bd), FIVE, me))
-					{
-						mvlist_insert_front(&bd->hlist[bd->num - 1], pos);
-						undo(bd);
-						return true;
-					}
-				}
-				else if(me == WHITE)
-				{
-					if(pattern_read(hpinc(bd), FIVE, me)
-					|| pattern_read(hpinc(bd), LONG, me))
-					{
-						mvlist_insert_front(&bd->hlist[bd->num - 1], pos);
-						undo(bd);
-						return true;
-					}
-				}
-			}
-			else
+			if(makes_five(bd, pos, me))
 			{
-				if(pattern_read(hpinc(bd), FIVE, me)
-				|| pattern_read(hpinc(bd), LONG, me))
-				{
-					mvlist_insert_front(&bd->hlist[bd->num - 1], pos);
-					undo(bd);
-					return true;
-				}
+				mvlist_insert_front(hlist(bd), pos);
+				return true;
 			}
-
-			undo(bd);
 			pos = mvlist_next(mlist(bd), pos);
 		}
 	}
@@ -211,6 +264,13 @@ static bool must_do_generate(board_t* bd, const u8 me, const u8 opp)
 		pos = mvlist_first(mlist(bd));
 		while(pos != END)
 		{
+			// the ends of the four are in its windows
+			if(!board_window(bd, pos, opp, 4))
+			{
+				pos = mvlist_next(mlist(bd), pos);
+				continue;
+			}
+
 			do_move_no_mvlist(bd, pos, me);
 
 			if(pattern_read(hpinc(bd), FREE4, opp) < 0)
@@ -232,6 +292,13 @@ static bool must_do_generate(board_t* bd, const u8 me, const u8 opp)
 		pos = mvlist_first(mlist(bd));
 		while(pos != END)
 		{
+			// the missing cell of the four
+			if(!board_window(bd, pos, opp, 4))
+			{
+				pos = mvlist_next(mlist(bd), pos);
+				continue;
+			}
+
 			do_move_no_mvlist(bd, pos, me);
 
 			if(pattern_read(hpinc(bd), DEAD4, opp) < 0)
@@ -252,6 +319,13 @@ static bool must_do_generate(board_t* bd, const u8 me, const u8 opp)
 		pos = mvlist_first(mlist(bd));
 		while(pos != END)
 		{
+			// a defence or a four of me is in a window of three discs
+			if(!(board_window(bd, pos, opp, 3) || board_window(bd, pos, me, 3)))
+			{
+				pos = mvlist_next(mlist(bd), pos);
+				continue;
+			}
+
 			do_move_no_mvlist(bd, pos, me);
 
 			if(pattern_read(hpinc(bd), FREE4, me) > 0)
@@ -270,10 +344,54 @@ static bool must_do_generate(board_t* bd, const u8 me, const u8 opp)
 	return false;
 }
 
-void heuristic_generate(board_t* bd, const search_t* srh, const u8 me, const u8 opp)
+// return true if me is black and can't move on pos
+static inline bool forbidden(board_t* bd, const u8 me, const u8 pos)
+{
+	return isForbidden && me == BLACK && board_forbidden(bd, pos);
+}
+
+// return true if the move just made by do_move_no_mvlist() makes a threat
+static inline bool is_forcing(const board_t* bd, const u8 me)
+{
+	return pattern_read(hpinc(bd), FREE4, me) > 0 || pattern_read(hpinc(bd), DEAD4, me) > 0
+		|| pattern_read(hpinc(bd), FREE3, me) > 0 || pattern_read(hpinc(bd), FREE3a, me) > 0;
+}
+
+/*
+ * Return the number of sorted candidates to keep.
+ * The leaf size shrinks by one every two plies below the root and candidates
+ * falling more than a free three behind the best one are cut.
+ */
+static u8 leaf_size(const search_t* srh, const u8 dep, const pair_t* pair, const u8 cnt)
+{
+	int leaf = srh->leaf, i;
+
+	if(srh->adapt)
+	{
+		if(srh->dep > dep)
+			leaf -= (srh->dep - dep) / 2;
+		if(leaf < LEAF_MIN)
+			leaf = LEAF_MIN;
+	}
+	if(leaf > cnt)
+		leaf = cnt;
+
+	if(srh->adapt)
+	{
+		for(i = LEAF_MIN; i < leaf; i++)
+			if(pair[0].key - pair[i].key > srh->sc.free3)
+				return i;
+	}
+
+	return leaf;
+}
+
+void heuristic_generate(board_t* bd, const search_t* srh, const u8 dep,
+						const u8 me, const u8 opp)
 {
 	pair_t pair[15 * 15];
-	u8 pos, i, cnt = 0;
+	u8 pos, i, leaf, cnt = 0;
+	bool skip = isForbidden && me == BLACK;
 
 	mvlist_remove_all(hlist(bd));
 
@@ -283,27 +401,34 @@ void heuristic_generate(board_t* bd, const search_t* srh, const u8 me, const u8
 	if(bd->num == 0)
 		mvlist_insert_front(hlist(bd), 112);
 
-	// generate helper array
-	pos = mvlist_first(mlist(bd));
-	while(pos != END)
+	// generate helper array, forbidden points only if nothing else is left
+	for(;;)
 	{
-		do_move_no_mvlist(bd, pos, me);
-		pair[cnt].pos = pos;
-		pair[cnt++].key = evaluate(bd, &srh->sc, me);
-		undo(bd);
-		pos = mvlist_next(mlist(bd), pos);
+		pos = mvlist_first(mlist(bd));
+		while(pos != END)
+		{
+			if(!skip || !board_forbidden(bd, pos))
+			{
+				do_move_no_mvlist(bd, pos, me);
+				pair[cnt].pos = pos;
+				pair[cnt].force = is_forcing(bd, me);
+				pair[cnt++].key = evaluate(bd, &srh->sc, me);
+				undo(bd);
+			}
+			pos = mvlist_next(mlist(bd), pos);
+		}
+		if(cnt > 0 || !skip)
+			break;
+		skip = false;
 	}
 	
 	// sort pair_t array descending
 	pair_sort(pair, cnt);
-	if(cnt < srh->leaf)
-	{
-		for(i = 0; i < cnt; i++)
-			mvlist_insert_back(hlist(bd), pair[i].pos);
-	}
-	else
+	leaf = leaf_size(srh, dep, pair, cnt);
+	for(i = 0; i < cnt; i++)
 	{
-		for(i = 0; i < srh->leaf; i++)
+		// threats are never cut in adaptive generation unless they lose
+		if(i < leaf || (srh->adapt && pair[i].force && pair[i].key > srh->sc.lose))
 			mvlist_insert_back(hlist(bd), pair[i].pos);
 	}
 }
@@ -313,6 +438,8 @@ static void heuristic_generate_root(board_t* bd, const search_t* srh,
 {
 	pair_t pair[15 * 15];
 	u8 pos, i, cnt = 0;
+	long val;
+	bool skip = isForbidden && me == BLACK;
 
 	mvlist_remove_all(hlist(bd));
 
@@ -322,16 +449,30 @@ static void heuristic_generate_root(board_t* bd, const search_t* srh,
 	if(bd->num == 0)
 		mvlist_insert_front(hlist(bd), 112);
 
-	// generate helper array
-	pos = mvlist_first(mlist(bd));
-	while(pos != END)
+	// generate helper array, forbidden points only if nothing else is left
+	for(;;)
 	{
-		do_move(bd, pos, me);
-		pair[cnt].pos = pos;
-		// here different from the former function
-		pair[cnt++].key = alphabeta(bd, srh, dep - 1, opp, LOSE - 1, WIN + 1, &i, 1);
-		undo(bd);
-		pos = mvlist_next(mlist(bd), pos);
+		pos = mvlist_first(mlist(bd));
+		while(pos != END)
+		{
+			if(!skip || !board_forbidden(bd, pos))
+			{
+				do_move(bd, pos, me);
+				// here different from the former function
+				val = alphabeta(bd, srh, dep - 1, opp, LOSE - 1, WIN + 1, &i, 1);
+				undo(bd);
+
+				// a stopped search keeps the moves searched so far
+				if(Abort || Stop)
+					break;
+				pair[cnt].pos = pos;
+				pair[cnt++].key = val;
+			}
+			pos = mvlist_next(mlist(bd), pos);
+		}
+		if(cnt > 0 || !skip || Abort || Stop)
+			break;
+		skip = false;
 	}
 	
 	// sort pair_t array descending
@@ -348,11 +489,278 @@ static void heuristic_generate_root(board_t* bd, const search_t* srh,
 	}
 }
 
+/*
+ * Return the remaining depth after the idx-th move of a node, just made by
+ * do_move(). Moves making or blocking a four are extended by one ply as long
+ * as the line stays within twice the nominal depth. Late moves making no
+ * threat are reduced by two plies so that the same side moves last at the
+ * horizon.
+ */
+static u8 child_depth(const board_t* bd, const search_t* srh, const u8 dep,
+						const int idx, const u8 mover, const u8 other)
+{
+	bool four, three;
+
+	four = pattern_read(pinc(bd), FREE4, mover) > 0 || pattern_read(pinc(bd), DEAD4, mover) > 0
+		|| pattern_read(pinc(bd), FREE4, other) < 0 || pattern_read(pinc(bd), DEAD4, other) < 0;
+	three = pattern_read(pinc(bd), FREE3, mover) > 0 || pattern_read(pinc(bd), FREE3a, mover) > 0
+		|| pattern_read(pinc(bd), FREE3, other) < 0 || pattern_read(pinc(bd), FREE3a, other) < 0;
+
+	if(srh->extend && four && bd->num - RootNum < 2 * srh->dep)
+		return dep;
+	if(srh->reduce && !four && !three && dep >= LMR_DEP && idx >= LMR_MOVES)
+		return dep - 3;
+	return dep - 1;
+}
+
+// return true if color has a four
+static inline bool has_four(const board_t* bd, const u8 color)
+{
+	return pattern_read(pat(bd), FREE4, color) || pattern_read(pat(bd), DEAD4, color);
+}
+
+// return true if color has a three, so it may make a four
+static inline bool has_three(const board_t* bd, const u8 color)
+{
+	return pattern_read(pat(bd), FREE3, color) || pattern_read(pat(bd), FREE3a, color)
+		|| pattern_read(pat(bd), DEAD3, color);
+}
+
+// return true if color makes a four by moving on pos
+static inline bool makes_four(const board_t* bd, const u8 pos, const u8 color)
+{
+	int d;
+	u8 sh;
+
+	for(d = 0; d < 4; d++)
+	{
+		sh = board_shape(bd, pos, color, d);
+		if(sh == FREE4 || sh == DEAD4 || sh == SHAPE_DOUBLE4)
+			return true;
+	}
+	return false;
+}
+
+// score of a win of color at ply after the current one
+static inline long win_score(const board_t* bd, const search_t* srh,
+							const u8 color, const int ply)
+{
+	return color == srh->me ? srh->sc.win - (bd->num + ply) : srh->sc.lose + (bd->num + ply);
+}
+
+/*
+ * Search the fours of the attacker, the side to move at the horizon, and the
+ * blocks they force below a horizon node. The side to move can stand on
+ * the static score unless it must block. The horizon node is made by
+ * do_move_no_mvlist() so its mlist is generated here first.
+ */
+static long quiesce(board_t* bd, const search_t* srh, const u8 next, const u8 attacker,
+					long alpha, long beta, const int qply)
+{
+	u8 other = next == srh->me ? srh->opp : srh->me;
+	u8 pos, win, block = INVALID;
+	int fives = 0;
+	long val, stand;
+
+	// the horizon node itself is counted and checked by alphabeta()
+	if(qply > 0)
+	{
+		Nodes++;
+		win = board_gameover(bd);
+		if(win == DRAW)
+			return 0;
+		if(win)
+			return win_score(bd, srh, win, 0);
+	}
+
+	stand = evaluate(bd, &srh->sc, srh->me);
+	if(qply >= QS_DEP || !(has_four(bd, next) || has_four(bd, other)
+		|| (next == attacker && has_three(bd, next))))
+		return stand;
+
+	if(qply == 0)
+		board_mvlist(bd);
+
+	// a five of the side to move ends the game, a five of the other side must
+	// be blocked
+	if(has_four(bd, next) || has_four(bd, other))
+	{
+		for(pos = mvlist_first(mlist(bd)); pos != END; pos = mvlist_next(mlist(bd), pos))
+		{
+			if(makes_five(bd, pos, next))
+				return win_score(bd, srh, next, 1);
+			if(makes_five(bd, pos, other))
+			{
+				fives++;
+				block = pos;
+			}
+		}
+		if(fives > 1)
+			return win_score(bd, srh, other, 2);
+	}
+
+	if(fives == 1)
+	{
+		do_move(bd, block, next);
+		val = quiesce(bd, srh, other, attacker, alpha, beta, qply + 1);
+		undo(bd);
+		return val;
+	}
+
+	// the side to move may stand on the static score
+	if(next != attacker)
+		return stand;
+	if(next == srh->me)
+	{
+		if(stand >= beta)
+			return stand;
+		if(stand > alpha)
+			alpha = stand;
+	}
+	else
+	{
+		if(stand <= alpha)
+			return stand;
+		if(stand < beta)
+			beta = stand;
+	}
+
+	for(pos = mvlist_first(mlist(bd)); pos != END; pos = mvlist_next(mlist(bd), pos))
+	{
+		if(!makes_four(bd, pos, next) || forbidden(bd, next, pos))
+			continue;
+
+		do_move(bd, pos, next);
+		val = quiesce(bd, srh, other, attacker, alpha, beta, qply + 1);
+		undo(bd);
+
+		if(next == srh->me && val > alpha)
+			alpha = val;
+		else if(next == srh->opp && val < beta)
+			beta = val;
+		if(alpha >= beta)
+			break;
+	}
+	return next == srh->me ? alpha : beta;
+}
+
+// pos is the new best move of the node at ply, prepend it to the child's line
+static inline void pv_update(const int ply, const u8 pos)
+{
+	int len = 0;
+
+	if(ply >= PV_MAX)
+		return;
+	Pv[ply][0] = pos;
+	if(ply + 1 < PV_MAX)
+	{
+		len = PvLen[ply + 1] < PV_MAX - 1 ? PvLen[ply + 1] : PV_MAX - 1;
+		memcpy(&Pv[ply][1], Pv[ply + 1], len);
+	}
+	PvLen[ply] = len + 1;
+}
+
+// send the current snapshot, force it or wait for the gap since the last one
+static void progress_send(const bool force)
+{
+	double now = wall_time();
+
+	if(!force && now - LastTime < PROGRESS_GAP)
+		return;
+	LastTime = now;
+
+	Info.nodes = Nodes;
+	Info.time = now - StartTime;
+	Info.nps = Info.time > 0.0 ? (u32)(Nodes / Info.time) : 0;
+	channel_push(Chan, &Info);
+}
+
+// stop the search at the node or time limit of srh
+static void limit_check(const search_t* srh)
+{
+	if((srh->nodes > 0 && Nodes >= srh->nodes)
+	|| (TimeLimit > 0.0 && wall_time() - StartTime >= TimeLimit))
+		Stop = true;
+}
+
+// FNV-1a step of a table salt
+static inline u64 salt_add(const u64 h, const u64 val)
+{
+	return (h ^ val) * 0x100000001b3ULL;
+}
+
+// salt of the table keys for the search constants srh, covering everything
+// the score of a node depends on besides the position and its depth
+static u64 table_salt(const search_t* srh)
+{
+	const unsigned char* p = (const unsigned char*)&srh->sc;
+	u64 h = 0xcbf29ce484222325ULL;
+	size_t i;
+
+	for(i = 0; i < sizeof(score_t); i++)
+		h = salt_add(h, p[i]);
+	h = salt_add(h, isForbidden);
+	h = salt_add(h, srh->me);
+	// tree shape, the adapted leaf size also depends on the full depth
+	h = salt_add(h, srh->leaf);
+	h = salt_add(h, srh->dep);
+	h = salt_add(h, srh->adapt);
+	h = salt_add(h, srh->reduce);
+	h = salt_add(h, srh->extend);
+	h = salt_add(h, srh->quiesce);
+	return h;
+}
+
+// return true if the table entry decides the score of a node searched to
+// dep within (alpha, beta)
+static inline bool table_cut(const tentry_t* ent, const u8 dep, const long alpha, const long beta)
+{
+	if(ent->dep < dep)
+		return false;
+	return ent->bound == TT_EXACT || (ent->bound == TT_LOWER && ent->score >= beta)
+		|| (ent->bound == TT_UPPER && ent->score <= alpha);
+}
+
+// store the score val of a node searched to dep within (alpha, beta)
+static inline long table_store(const board_t* bd, const u8 dep, const long alpha,
+								const long beta, const long val, const u8 move)
+{
+	u8 bound = val <= alpha ? TT_UPPER : (val >= beta ? TT_LOWER : TT_EXACT);
+
+	if(Table != NULL && !Abort && !Stop && bd->num > RootNum)
+		tt_store(Table, bd->sym[0] ^ Salt, val, dep, bound, move);
+	return val;
+}
+
+// move the table move of a node to the front of its hlist
+static inline void table_order(board_t* bd, const u8 move)
+{
+	if(move != INVALID && mvlist_first(hlist(bd)) != move && mvlist_remove(hlist(bd), move))
+		mvlist_insert_front(hlist(bd), move);
+}
+
 long alphabeta(board_t* bd, const search_t* srh, const u8 dep, 
 				const u8 next, long alpha, long beta, u8* best, const bool heu)
 {
-	long val;
-	u8 pos, tmp;
+	long val, alpha0 = alpha, beta0 = beta;
+	u8 pos, tmp, sub, move = INVALID, hint = INVALID;
+	int idx = 0, ply = bd->num - RootNum;
+	const tentry_t* ent;
+	Nodes++;
+
+	// unwind quickly, the parent discards the result
+	if(Abort || Stop)
+		return 0;
+
+	if(ply < PV_MAX)
+		PvLen[ply] = 0;
+	if((Nodes & TICK_MASK) == 0)
+	{
+		if(Chan != NULL)
+			progress_send(false);
+		limit_check(srh);
+	}
+
 	tmp = board_gameover(bd);
 
 	if(tmp == srh->me)
@@ -362,7 +770,19 @@ long alphabeta(board_t* bd, const search_t* srh, const u8 dep,
 	if(tmp == DRAW)
 		return 0;
 	if(dep <= 0)
+	{
+		if(srh->quiesce)
+			return quiesce(bd, srh, next, next, alpha, beta, 0);
 		return evaluate(bd, &srh->sc, srh->me);
+	}
+
+	// the root needs a move, so only other nodes are cut by the table
+	if(Table != NULL && ply > 0 && (ent = tt_probe(Table, bd->sym[0] ^ Salt)) != NULL)
+	{
+		if(table_cut(ent, dep, alpha, beta))
+			return ent->score;
+		hint = ent->best;
+	}
 
 	// min node
 	if(next == srh->opp)
@@ -370,7 +790,10 @@ long alphabeta(board_t* bd, const search_t* srh, const u8 dep,
 		if(dep > 1)
 		{
 			if(heu)
-				heuristic_generate(bd, srh, srh->opp, srh->me);
+			{
+				heuristic_generate(bd, srh, dep, srh->opp, srh->me);
+				table_order(bd, hint);
+			}
 			pos = mvlist_first(hlist(bd));
 		}
 		else
@@ -378,18 +801,38 @@ long alphabeta(board_t* bd, const search_t* srh, const u8 dep,
 
 		while(pos != END)
 		{
+			// mlist isn't filtered like hlist
+			if(dep <= 1 && forbidden(bd, srh->opp, pos))
+			{
+				pos = mvlist_next(mlist(bd), pos);
+				continue;
+			}
+
 			if(dep > 1)
+			{
 				do_move(bd, pos, srh->opp);
+				sub = child_depth(bd, srh, dep, idx++, srh->opp, srh->me);
+			}
 			else
+			{
 				do_move_no_mvlist(bd, pos, srh->opp);
+				sub = 0;
+			}
 
-			val = alphabeta(bd, srh, dep - 1, srh->me, alpha, beta, &tmp, 1);
+			val = alphabeta(bd, srh, sub, srh->me, alpha, beta, &tmp, 1);
+
+			// re-search a reduced move at full depth if it beats the bound
+			if(sub < dep - 1 && val < beta)
+				val = alphabeta(bd, srh, dep - 1, srh->me, alpha, beta, &tmp, 1);
 			undo(bd);
+			if(Abort || Stop)
+				break;
 
 			if(val < beta)
 			{
 				beta = val;
-				*best = pos;
+				*best = move = pos;
+				pv_update(ply, pos);
 			}
 			if(beta <= alpha)
 				break;
@@ -399,7 +842,7 @@ long alphabeta(board_t* bd, const search_t* srh, const u8 dep,
 			else
 				pos = mvlist_next(mlist(bd), pos);
 		}
-		return beta;
+		return table_store(bd, dep, alpha0, beta0, beta, move);
 	}
 
 	// max node	
@@ -408,7 +851,10 @@ long alphabeta(board_t* bd, const search_t* srh, const u8 dep,
 		if(dep > 1)
 		{
 			if(heu)
-				heuristic_generate(bd, srh, srh->me, srh->opp);
+			{
+				heuristic_generate(bd, srh, dep, srh->me, srh->opp);
+				table_order(bd, hint);
+			}
 			pos = mvlist_first(hlist(bd));
 		}
 		else
@@ -416,18 +862,47 @@ long alphabeta(board_t* bd, const search_t* srh, const u8 dep,
 
 		while(pos != END)
 		{
+			// mlist isn't filtered like hlist
+			if(dep <= 1 && forbidden(bd, srh->me, pos))
+			{
+				pos = mvlist_next(mlist(bd), pos);
+				continue;
+			}
+
 			if(dep > 1)
+			{
 				do_move(bd, pos, srh->me);
+				sub = child_depth(bd, srh, dep, idx++, srh->me, srh->opp);
+			}
 			else
+			{
 				do_move_no_mvlist(bd, pos, srh->me);
+				sub = 0;
+			}
+
+			val = alphabeta(bd, srh, sub, srh->opp, alpha, beta, &tmp, 1);
 
-			val = alphabeta(bd, srh, dep - 1, srh->opp,	alpha, beta, &tmp, 1);
+			// re-search a reduced move at full depth if it beats the bound
+			if(sub < dep - 1 && val > alpha)
+				val = alphabeta(bd, srh, dep - 1, srh->opp, alpha, beta, &tmp, 1);
 			undo(bd);
+			if(Abort || Stop)
+				break;
 
 			if(val > alpha)
 			{
 				alpha = val;
-				*best = pos;
+				*best = move = pos;
+				pv_update(ply, pos);
+
+				// a new best root move
+				if(ply == 0 && Chan != NULL)
+				{
+					Info.best = pos;
+					Info.score = val;
+					Info.pvlen = PvLen[0];
+					memcpy(Info.pv, Pv[0], PvLen[0]);
+				}
 			}
 			if(alpha >= beta)
 				break;
@@ -437,14 +912,118 @@ long alphabeta(board_t* bd, const search_t* srh, const u8 dep,
 			else
 				pos = mvlist_next(mlist(bd), pos);
 		}
-		return alpha;
+		return table_store(bd, dep, alpha0, beta0, alpha, move);
 	}
 	return 0;
 }
 
+void search_abort(const bool flag)
+{
+	Abort = flag;
+}
+
+bool search_aborted()
+{
+	return Abort;
+}
+
+bool search_limited()
+{
+	return Stop;
+}
+
+void search_channel(channel_t* chan)
+{
+	Chan = chan;
+}
+
+u64 search_nodes()
+{
+	return Nodes;
+}
+
+long search_score()
+{
+	return Score;
+}
+
+void search_table(ttable_t* tab)
+{
+	Table = tab;
+}
+
+void search_eval_stats(u64* probes, u64* hits)
+{
+	*probes = EvalProbes;
+	*hits = EvalHits;
+}
+
+size_t search_eval_memory()
+{
+	return sizeof(EvalTab);
+}
+
+/*
+ * Iterative deepening under the time manager, two plies per iteration so that
+ * the same side moves last at every horizon. The best move of an iteration is
+ * searched first in the next one, a stopped iteration keeps its best move if
+ * any root move is finished. A single forced reply isn't searched.
+ */
+static u8 deepen(board_t* bd, const search_t* srh)
+{
+	tman_t tm;
+	u8 best, move;
+	int dep;
+	long val;
+
+	tman_start(&tm, srh, bd->num);
+	TimeLimit = tm.hard;
+
+	heuristic_generate(bd, srh, srh->dep, srh->me, srh->opp);
+	best = mvlist_first(hlist(bd));
+	if(mvlist_size(hlist(bd)) == 1)
+		return best;
+
+	for(dep = srh->dep % 2 ? 3 : 2; ; dep += 2)
+	{
+		if(dep > srh->dep)
+			dep = srh->dep;
+		Info.dep = dep;
+		move = best;
+		val = alphabeta(bd, srh, dep, srh->me, LOSE - 1, WIN + 1, &move, 0);
+		best = move;
+		if(Abort || Stop)
+			break;
+
+		Score = val;
+		table_order(bd, best);
+		tman_update(&tm, best, val, srh->sc.free3);
+
+		// a proven win needs no more search
+		if(dep >= srh->dep || val > srh->sc.win - 15 * 15
+		|| !tman_next(&tm, wall_time() - StartTime))
+			break;
+	}
+	return best;
+}
+
 u8 heuristic(board_t* bd, const search_t* srh)
 {
 	u8 tmp = 0;
+	Nodes = 0;
+	Score = 0;
+	RootNum = bd->num;
+	Stop = false;
+
+	// scores of the last search may come from other constants or rules
+	EvalAge++;
+	EvalProbes = 0;
+	EvalHits = 0;
+	if(Table != NULL)
+	{
+		tt_new_search(Table);
+		Salt = table_salt(srh);
+	}
 	
 	// first move
 	if(bd->num == 0)
@@ -453,30 +1032,19 @@ u8 heuristic(board_t* bd, const search_t* srh)
 	// ai plays black and uses opening book
 	if(srh->me == BLACK && srh->book)
 	{
-		if(bd->num == 2)
+		// enter the book right after white's first move, or on black's
+		// first own move when the game starts from a three-stone opening
+		if(bd->num == 2 || (bd->num == 4 && !bd->book))
 		{
-			tmp = mvlist_next(mstk(bd), mvlist_first(mstk(bd)));
-
-			if(tmp == 97 || tmp == 111 || tmp == 127 || tmp == 113)
-			{
-				book_choose_direct();
-				BookInUse = true;
-				book_generate(bd);
+			bd->book = book_generate(bd);
+			if(bd->book)
 				return mvlist_first(hlist(bd));
-			}
-			else if(tmp == 96 || tmp == 126 || tmp == 128 || tmp == 98)
-			{
-				book_choose_indirect();
-				BookInUse = true;
-				book_generate(bd);
-				return mvlist_first(hlist(bd));
-			}
 		}
 
-		else if(BookInUse)
+		else if(bd->book)
 		{
 			if(!book_generate(bd))
-				BookInUse = false;
+				bd->book = false;
 			else
 			{
 				tmp = mvlist_first(hlist(bd));
@@ -493,10 +1061,17 @@ u8 heuristic(board_t* bd, const search_t* srh)
 		}
 	}
 
-	// do the second move randomly when ai plays white
-	else if(srh->me == WHITE && mvlist_first(mstk(bd)) == 112 && bd->num == 1)
+	// ai plays white and the book has an analyzed move
+	else if(srh->me == WHITE && srh->book && book_lookup(bd))
 	{
-		BookInUse = false;
+		bd->book = false;
+		return mvlist_first(hlist(bd));
+	}
+
+	// otherwise do the second move randomly when ai plays white
+	else if(srh->me == WHITE && srh->book && mvlist_first(mstk(bd)) == 112 && bd->num == 1)
+	{
+		bd->book = false;
 		tmp = rand() % 8;
 		switch(tmp)
 		{
@@ -521,16 +1096,41 @@ u8 heuristic(board_t* bd, const search_t* srh)
 		}
 	}
 
-	if(srh->dep >= 6 && srh->presrh)
+	StartTime = LastTime = wall_time();
+	Info.best = INVALID;
+	Info.score = 0;
+	Info.pvlen = 0;
+
+	TimeLimit = srh->time / 1000.0;
+
+	tmp = INVALID;
+	if(srh->time > 0 || srh->left > 0)
+		tmp = deepen(bd, srh);
+	else if(srh->dep >= 6 && srh->presrh)
 	{
+		Info.dep = srh->dep - 4;
 		heuristic_generate_root(bd, srh, srh->dep - 4, srh->me, srh->opp);
-		alphabeta(bd, srh, srh->dep, srh->me, LOSE - 1, WIN + 1, &tmp, 0);
+		Info.dep = srh->dep;
+		Score = alphabeta(bd, srh, srh->dep, srh->me, LOSE - 1, WIN + 1, &tmp, 0);
 	}
 	else
 	{
-		alphabeta(bd, srh, srh->dep, srh->me, LOSE - 1, WIN + 1, &tmp, 1);
+		Info.dep = srh->dep;
+		Score = alphabeta(bd, srh, srh->dep, srh->me, LOSE - 1, WIN + 1, &tmp, 1);
 	}
 
+	// stopped before any root move is searched, the pre-search order or the
+	// static order decides
+	if(tmp == INVALID && Stop)
+	{
+		if(mvlist_size(hlist(bd)) == 0)
+			heuristic_generate(bd, srh, srh->dep, srh->me, srh->opp);
+		tmp = mvlist_first(hlist(bd));
+	}
+
+	if(Chan != NULL)
+		progress_send(true);
+
 	return tmp;
 }
 
@@ -17,6 +17,8 @@ extern "C" {
 
 #include "macro.h"
 #include "board.h"
+#include "progress.h"
+#include "ttable.h"
 
 // score structure
 typedef struct {
@@ -44,23 +46,38 @@ typedef struct {
 	u8 dep;			// alpha-beta search depth
 	bool presrh;	// if do shallower search first
 	bool book;		// if use open book
+	bool adapt;		// if adapt leaf size to depth and score gap
+	bool reduce;	// if reduce late quiet moves
+	bool extend;	// if extend moves making or blocking a four
+	bool quiesce;	// if search fours and their blocks beyond the horizon
+	u64 nodes;		// node limit of a search, 0 for none
+	u32 time;		// time limit of a search in milliseconds, 0 for none
+	u32 memory;		// memory limit of the table, the book and the evaluation
+					// cache in megabytes, 0 for none, applied by the owner
+					// of the table
+	u32 left;		// remaining match time in milliseconds, 0 for no clock
+	u32 inc;		// match time added per move in milliseconds
 } search_t;
 
 /*
- * Return the score of board for color.
+ * Return the score of board for color. Scores are cached per thread within
+ * one heuristic().
  */
 long evaluate(const board_t* bd, const score_t* sc, const u8 color);
 
 /*
  * Generate hlist(bd).
- * Some forbidden points are not considered to avoid empty hlist.
+ * Forbidden points of black are skipped unless no other point is left, but
+ * must-do moves are kept.
  *
  * @param [out]	bd		The hlist member of bd is changed.
  * @param [in]	srh		The search_t structure.
+ * @param [in]	dep		Remaining search depth, used by adaptive leaf size.
  * @param [in]	me		My color.
  * @param [in]	opp		Opponent's color.
  */
-void heuristic_generate(board_t* bd, const search_t* srh, const u8 me, const u8 opp);
+void heuristic_generate(board_t* bd, const search_t* srh, const u8 dep,
+						const u8 me, const u8 opp);
 
 /*
  * Alpha-beta search with heuristically generated moves
@@ -77,8 +94,63 @@ void heuristic_generate(board_t* bd, const search_t* srh, const u8 me, const u8
 long alphabeta(board_t* bd, const search_t* srh, const u8 dep, 
 				const u8 next, long alpha, long beta, u8* best, const bool heu);
 
+/*
+ * Ask the searches running on all threads to stop, or clear the request.
+ * The flag stays set until cleared, an aborted heuristic() returns a
+ * meaningless move.
+ */
+void search_abort(const bool flag);
+
+/*
+ * Return true if searches are asked to stop.
+ */
+bool search_aborted();
+
+/*
+ * Return true if the last heuristic() of this thread stopped at its node or
+ * time limit. Its move is then the best one found so far.
+ */
+bool search_limited();
+
+/*
+ * Publish progress snapshots of the searches on the calling thread to a
+ * channel, at most one per 0.1 second plus the final one. NULL stops it.
+ */
+void search_channel(channel_t* chan);
+
+/*
+ * Keep the results of the searches on the calling thread in a table, which
+ * then serves the following searches too. NULL stops it.
+ */
+void search_table(ttable_t* tab);
+
+/*
+ * Return the number of nodes searched by the last heuristic() of this thread.
+ */
+u64 search_nodes();
+
+/*
+ * Return the root score of the last heuristic() of this thread for the side
+ * to move, 0 if it didn't search.
+ */
+long search_score();
+
+/*
+ * Get the evaluation cache probes and hits of the last heuristic() of this
+ * thread.
+ */
+void search_eval_stats(u64* probes, u64* hits);
+
+/*
+ * Return the bytes of the evaluation cache, which every searching thread
+ * has.
+ */
+size_t search_eval_memory();
+
 /*
  * Return the best position to move.
+ * With a match clock or a time limit the search deepens two plies at a time
+ * up to dep as the time manager allows, see timeman.h.
  */
 u8 heuristic(board_t* bd, const search_t* srh);
 
@@ -0,0 +1,91 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * thread.c - minimal portable threads
+ */
+
+#include "thread.h"
+#include "macro.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/time.h>
+#endif
+
+#ifdef _WIN32
+// start routine adapter, CreateThread expects a different signature
+typedef struct {
+	void* (*fn)(void*);
+	void* arg;
+} start_t;
+
+static DWORD WINAPI thread_start(LPVOID param)
+{
+	start_t st = *(start_t*)param;
+	free(param);
+	st.fn(st.arg);
+	return 0;
+}
+#endif
+
+bool thread_create(thread_t* tid, void* (*fn)(void*), void* arg)
+{
+#ifdef _WIN32
+	start_t* st = (start_t*)malloc(sizeof(start_t));
+
+	if(st == NULL)
+		return false;
+	st->fn = fn;
+	st->arg = arg;
+	if((*tid = CreateThread(NULL, 0, thread_start, st, 0, NULL)) == NULL)
+	{
+		free(st);
+		return false;
+	}
+	return true;
+#else
+	return pthread_create(tid, NULL, fn, arg) == 0;
+#endif
+}
+
+void thread_join(thread_t tid)
+{
+#ifdef _WIN32
+	WaitForSingleObject(tid, INFINITE);
+	CloseHandle(tid);
+#else
+	pthread_join(tid, NULL);
+#endif
+}
+
+int cpu_count()
+{
+	int n;
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	n = info.dwNumberOfProcessors;
+#else
+	n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return n > 0 ? n : 1;
+}
+
+double wall_time()
+{
+#ifdef _WIN32
+	LARGE_INTEGER cnt, freq;
+	QueryPerformanceCounter(&cnt);
+	QueryPerformanceFrequency(&freq);
+	return (double)cnt.QuadPart / freq.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#endif
+}
+
@@ -0,0 +1,68 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * thread.h - minimal portable threads
+ *
+ * On Windows this header includes windows.h, which typedefs LONG. The shape
+ * code LONG of pattern.h is set aside meanwhile, so the headers can be
+ * included in any order.
+ */
+
+#ifndef __THREAD_H__
+#define __THREAD_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#ifdef _WIN32
+#pragma push_macro("LONG")
+#undef LONG
+#include <windows.h>
+#pragma pop_macro("LONG")
+typedef HANDLE thread_t;
+#else
+#include <pthread.h>
+typedef pthread_t thread_t;
+#endif
+
+#include "macro.h"
+
+// full memory barrier between threads
+#if defined(_MSC_VER)
+#define memory_barrier()	MemoryBarrier()
+#else
+#define memory_barrier()	__sync_synchronize()
+#endif
+
+/*
+ * Start fn(arg) on a new thread.
+ * Return false if the thread can't be created.
+ */
+bool thread_create(thread_t* tid, void* (*fn)(void*), void* arg);
+
+/*
+ * Wait for a thread to finish.
+ */
+void thread_join(thread_t tid);
+
+/*
+ * Return the number of online processors.
+ */
+int cpu_count();
+
+/*
+ * Return wall clock time in seconds from an arbitrary origin.
+ */
+double wall_time();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
+
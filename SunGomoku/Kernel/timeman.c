@@ -0,0 +1,80 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * timeman.c - time management of searches under a match clock
+ */
+
+#include "timeman.h"
+#include "macro.h"
+
+#define TM_TOGO			30		// moves left to plan for at the start of a game
+#define TM_TOGO_MIN		10		// moves left to plan for late in a game
+#define TM_RESERVE		0.2		// seconds of the match clock never planned
+#define TM_MIN			0.01	// shortest budget in seconds
+#define TM_EXTEND		1.5		// soft budget growth on an unstable iteration
+#define TM_SCALE_MAX	4.0		// maximum growth of the soft budget
+#define TM_NEXT			0.25	// a new iteration starts only before this share of
+								// the budget is used, two more plies cost several
+								// times the iterations before
+
+void tman_start(tman_t* tm, const search_t* srh, const u8 num)
+{
+	double left = srh->left / 1000.0 - TM_RESERVE;
+	double inc = srh->inc / 1000.0;
+	int togo = TM_TOGO - num / 4;
+
+	if(togo < TM_TOGO_MIN)
+		togo = TM_TOGO_MIN;
+	if(left < 0.0)
+		left = 0.0;
+
+	// without a clock the time limit of the move is the whole budget
+	if(srh->left == 0)
+		tm->soft = tm->hard = srh->time / 1000.0;
+	else
+	{
+		// the increment arrives with the move, only most of it is spent
+		tm->soft = left / togo + inc * 0.75;
+		tm->hard = left / 4 + inc * 0.75;
+		if(tm->hard > tm->soft * TM_SCALE_MAX)
+			tm->hard = tm->soft * TM_SCALE_MAX;
+	}
+
+	// the time limit of the move caps both
+	if(srh->time > 0 && tm->hard > srh->time / 1000.0)
+		tm->hard = srh->time / 1000.0;
+	if(tm->hard < TM_MIN)
+		tm->hard = TM_MIN;
+	if(tm->soft > tm->hard)
+		tm->soft = tm->hard;
+
+	tm->scale = 1.0;
+	tm->best = INVALID;
+	tm->score = 0;
+}
+
+void tman_update(tman_t* tm, const u8 best, const long score, const long drop)
+{
+	if(tm->best != INVALID && best != tm->best)
+		tm->scale *= TM_EXTEND;
+	if(tm->best != INVALID && score < tm->score - drop)
+		tm->scale *= TM_EXTEND;
+	if(tm->scale > TM_SCALE_MAX)
+		tm->scale = TM_SCALE_MAX;
+
+	tm->best = best;
+	tm->score = score;
+}
+
+bool tman_next(const tman_t* tm, const double elapsed)
+{
+	double budget = tm->soft * tm->scale;
+
+	if(budget > tm->hard)
+		budget = tm->hard;
+	return elapsed < budget * TM_NEXT;
+}
@@ -0,0 +1,60 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * timeman.h - time management of searches under a match clock
+ *
+ * A move gets a share of the remaining match time and most of the increment
+ * as its soft budget, and at most a quarter of the remaining time as its hard
+ * budget. Without a match clock, both budgets are the time limit of the
+ * move. The soft budget grows when the best move changes between
+ * iterations or the score drops. heuristic() starts the next iteration only
+ * while less than a quarter of the soft budget is used, since two more plies
+ * take several times as long as all iterations before. The search is stopped
+ * at the hard budget.
+ */
+
+#ifndef __TIMEMAN_H__
+#define __TIMEMAN_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include "macro.h"
+#include "search.h"
+
+// time manager of one search
+typedef struct {
+	double soft;		// seconds the search should take
+	double hard;		// seconds the search must not exceed
+	double scale;		// extension of the soft budget so far
+	u8 best;			// best move of the last iteration, INVALID if none
+	long score;			// score of the last iteration
+} tman_t;
+
+/*
+ * Plan the budgets of a search with srh on a board of num discs.
+ */
+void tman_start(tman_t* tm, const search_t* srh, const u8 num);
+
+/*
+ * Record the result of a finished iteration. A new best move or a score
+ * falling by more than drop extends the soft budget.
+ */
+void tman_update(tman_t* tm, const u8 best, const long score, const long drop);
+
+/*
+ * Return true if another iteration should start after elapsed seconds.
+ */
+bool tman_next(const tman_t* tm, const double elapsed);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
+
@@ -10,74 +10,80 @@
 
 #include "tree.h" 
 #include "macro.h"
-#include "key.h"
 #include "mvlist.h"
 #include "board.h"
 
 // #include "interface.h"
 
-tree_t* tree_init()
+tree_t* tree_init(const u32 cap)
 {
 	tree_t* tree = (tree_t*)malloc(sizeof(tree_t));
-	tnode_t* root = (tnode_t*)malloc(sizeof(tnode_t));
-
-	tree->root = root;
-	tree->tptr = root;
-	tree->list[0] = 112;
-	tree->num = 1;
-
-	// set root H8 and MID_RIGHT
-	tree->root->pos = 112;
-	tree->root->info = MID_RIGHT;
-	tree->root->up = NULL;
-	tree->root->down = NULL;
-	tree->root->next = NULL;
-	key_gen_arr(&root->key, tree->list, tree->num);
 
+	tree->cap = cap > 0 ? cap : 1;
+	tree->node = (tnode_t*)malloc(tree->cap * sizeof(tnode_t));
+	tree_reset(tree);
 	return tree;
 }
 
+void tree_reserve(tree_t* tree, const u32 cap)
+{
+	if(cap <= tree->cap)
+		return;
+	tree->node = (tnode_t*)realloc(tree->node, cap * sizeof(tnode_t));
+	tree->cap = cap;
+}
+
 void tree_insert(tree_t* tree, const u8 pos, const u8 info)
 {
-	tnode_t* node = (tnode_t*)malloc(sizeof(tnode_t));
+	tnode_t* cur;
+	tnode_t* node;
+	u32 idx;
+
+	// indices stay valid when the arena moves
+	if(tree->size == tree->cap)
+		tree_reserve(tree, 2 * tree->cap);
+
+	idx = tree->size++;
+	node = &tree->node[idx];
+	cur = &tree->node[tree->tptr];
 
 	node->pos = pos;
 	node->info = info;
-	node->up = NULL;
-	node->down = NULL;
-	node->next = NULL;
+	node->up = NIL;
+	node->down = NIL;
+	node->next = NIL;
 
 	// info 0x00 or 0x80
-	if(tree->tptr->info == MID || tree->tptr->info == MID_RIGHT)
+	if(cur->info == MID || cur->info == MID_RIGHT)
 	{
-		tree->tptr->down = node;
+		cur->down = idx;
 		node->up = tree->tptr;
 	}
 
 	// info 0xc0
-	else if(tree->tptr->info == LEAF)
+	else if(cur->info == LEAF)
 	{
 		tree->num--;
-		node->up = tree->tptr->up;
-		tree->tptr->next = node;
+		node->up = cur->up;
+		cur->next = idx;
 	}
 
 	// info 0x40
-	else if(tree->tptr->info == LEAF_RIGHT)
+	else if(cur->info == LEAF_RIGHT)
 	{
 		tree->num--;
-		while(tree->tptr->info != MID)
+		while(cur->info != MID)
 		{
 			tree->num--;
-			tree->tptr = tree->tptr->up;
+			tree->tptr = cur->up;
+			cur = &tree->node[tree->tptr];
 		}
-		node->up = tree->tptr->up;
-		tree->tptr->next = node;
+		node->up = cur->up;
+		cur->next = idx;
 	}
 
 	tree->list[tree->num++] = pos;
-	key_gen_arr(&node->key, tree->list, tree->num);
-	tree->tptr = node;
+	tree->tptr = idx;
 #if 0
 	for(int i = 0; i < tree->num; i++)
 	{
@@ -88,125 +94,42 @@ void tree_insert(tree_t* tree, const u8 pos, const u8 info)
 #endif
 }
 
-static void tree_reset_helper(tree_t* tree)
-{
-	tree_t sub;
-	tnode_t* tmp;
-	
-	if(tree->root->down == NULL)
-		return;
-	else
-	{
-		sub.root = tree->root->down;
-		while(1)
-		{
-			tree_reset(&sub);
-			tmp = sub.root->next;
-			free(sub.root);
-			sub.root = tmp;
-			if(sub.root == NULL)
-				break;
-		}
-	}
-	
-	tree->root->down = NULL;
-}
-
 void tree_reset(tree_t* tree)
 {
-	tree_reset_helper(tree);
-	tree->tptr = tree->root;
+	tnode_t* root = &tree->node[0];
+
+	tree->size = 1;
+	tree->tptr = 0;
+	tree->list[0] = 112;
 	tree->num = 1;
+
+	// set root H8 and MID_RIGHT
+	root->pos = 112;
+	root->info = MID_RIGHT;
+	root->up = NIL;
+	root->down = NIL;
+	root->next = NIL;
 }
 
 void tree_delete(tree_t* tree)
 {
-	tree_reset(tree);
-	free(tree->root);
+	free(tree->node);
 	free(tree);
 }
 
-void preorder_traversal(const tree_t* tree)
+static void preorder_helper(const tree_t* tree, const u32 idx)
 {
-	tree_t sub;
+	u32 child;
 
 #if 0
-	printf("%d\t\t%x\n", tree->root->pos, tree->root->info);
-#endif
-#if 0
-	print_position(tree->root->pos);
-	printf("\t\t%x\t\t", tree->root->info);
-	if(tree->root->up != NULL)
-	{
-		print_position(tree->root->up->pos);
-		printf("\t\t");
-	}
-	else
-		printf("%d\t\t", tree->root->up);
-	if(tree->root->down != NULL)
-	{
-		print_position(tree->root->down->pos);
-		printf("\t\t");
-	}
-	else
-		printf("%d\t\t", tree->root->down);
-	if(tree->root->next != NULL)
-	{
-		print_position(tree->root->next->pos);
-		printf("\n");
-	}
-	else
-		printf("%d\n", tree->root->next);
+	printf("%d\t\t%x\n", tree->node[idx].pos, tree->node[idx].info);
 #endif
 
-	if(tree->root->down == NULL)
-		return;
-	else
-	{
-		sub.root = tree->root->down;
-		while(1)
-		{
-			preorder_traversal(&sub);
-			sub.root = sub.root->next;
-			if(sub.root == NULL)
-				break;
-		}
-	}
+	for(child = tree->node[idx].down; child != NIL; child = tree->node[child].next)
+		preorder_helper(tree, child);
 }
 
-bool tree_find_key(const tree_t* tree, const key_t* key, const int dep, board_t* bd)
+void preorder_traversal(const tree_t* tree)
 {
-	tree_t sub;
-	tnode_t* tmp;
-
-	if(key_issame(&tree->root->key, key))
-	{
-		tmp = tree->root->down;
-		while(tmp != NULL)
-		{
-			mvlist_insert_back(hlist(bd), tmp->pos);
-			tmp = tmp->next;
-		}
-		return true;
-	}
-
-	if(dep <= 0)
-		return false;
-
-	if(tree->root->down == NULL)
-		return false;
-	else
-	{
-		sub.root = tree->root->down;
-		while(1)
-		{
-			if(tree_find_key(&sub, key, dep - 1, bd))
-				return true;
-			sub.root = sub.root->next;
-			if(sub.root == NULL)
-				break;
-		}
-	}
-	return false;
+	preorder_helper(tree, 0);
 }
-
@@ -19,7 +19,6 @@ extern "C" {
 
 #include "macro.h"
 #include "mvlist.h"
-#include "key.h"
 #include "board.h"
 
 // node info macros
@@ -28,28 +27,37 @@ extern "C" {
 #define LEAF		0xc0	// leaf with right nodes
 #define LEAF_RIGHT	0x40	// rightmost leaf
 
-// tree node structure
-typedef struct tnode {
+// index of no node, the root is never a child or a brother
+#define NIL			0
+
+// tree node structure, nodes refer to each other by arena index
+typedef struct {
+	u32 up;					// parent node
+	u32 down;				// children node
+	u32 next;				// brother node
 	u8 pos;					// position
 	u8 info;				// node info
-	struct tnode* up;		// parent node
-	struct tnode* down;		// children node
-	struct tnode* next;		// brother node
-	key_t key;				// path key
 } tnode_t; 
 
 // tree structure
 typedef struct {
-	tnode_t* root;		// root node
-	tnode_t* tptr;		// pointer to the current node
+	tnode_t* node;		// node arena, node[0] is the root
+	u32 size;			// # of nodes in use
+	u32 cap;			// arena capacity
+	u32 tptr;			// the current node
 	u8 list[15 * 15];	// move stack
 	u8 num;				// list size
 } tree_t;
 
 /*
- * Return the pointer to a new tree.
+ * Return the pointer to a new tree with room for cap nodes.
+ */
+tree_t* tree_init(const u32 cap);
+
+/*
+ * Make room for cap nodes at once, the arena grows anyway when full.
  */
-tree_t* tree_init();
+void tree_reserve(tree_t* tree, const u32 cap);
 
 /*
  * Insert a node.
@@ -57,7 +65,7 @@ tree_t* tree_init();
 void tree_insert(tree_t* tree, const u8 pos, const u8 info);
 
 /*
- * Reset a tree to root node.
+ * Reset a tree to root node, keeping the arena.
  */
 void tree_reset(tree_t* tree);
 
@@ -71,13 +79,6 @@ void tree_delete(tree_t* tree);
  */
 void preorder_traversal(const tree_t* tree);
 
-/*
- * Find key in the tree using depth first preorder traversal.
- * Add all children of the target nodes to hlist(bd).
- * Maximum search depth is limited to dep.
- */
-bool tree_find_key(const tree_t* tree, const key_t* key, const int dep, board_t* bd);
-
 #ifdef  __cplusplus
 }
 #endif
@@ -0,0 +1,181 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * ttable.c - transposition table kept across searches
+ */
+
+#include "ttable.h"
+#include "macro.h"
+#include "mapfile.h"
+
+// learned positions file layout: head, entries
+#define TT_MAGIC		0x54544753		// "SGTT" in little endian
+#define TT_VERSION		1
+
+// searches between two sweeps of the entry ages, below 256 so that an
+// older entry never wraps around to the current age
+#define TT_AGE_SWEEP	128
+
+// learned positions file head
+typedef struct {
+	u32 magic;
+	u32 version;
+	u32 num;			// entry number
+	u32 reserved;
+} thead_t;
+
+// return the first entry of the bucket of key
+static inline tentry_t* bucket(const ttable_t* tab, const u64 key)
+{
+	return &tab->ent[key & tab->mask & ~(u64)1];
+}
+
+// store an entry of age into its bucket
+static void store(ttable_t* tab, const u64 key, const long score, const u8 dep,
+					const u8 bound, const u8 best, const u8 age)
+{
+	tentry_t* b = bucket(tab, key);
+	tentry_t* e;
+
+	if(b[0].key == key)
+		e = &b[0];
+	else if(b[1].key == key)
+		e = &b[1];
+	// entries of the current search are kept if possible, then the deeper one
+	else if((b[0].age == tab->age) != (b[1].age == tab->age))
+		e = b[0].age == tab->age ? &b[1] : &b[0];
+	else
+		e = b[1].dep < b[0].dep ? &b[1] : &b[0];
+
+	// a result without a move keeps the move of the same position
+	if(best != INVALID || e->key != key)
+		e->best = best;
+	e->key = key;
+	e->score = (int32_t)score;
+	e->dep = dep;
+	e->bound = bound;
+	e->age = age;
+}
+
+bool tt_init(ttable_t* tab, const int bits)
+{
+	tab->ent = (tentry_t*)calloc((size_t)1 << bits, sizeof(tentry_t));
+	tab->mask = tab->ent != NULL ? (u32)(((u64)1 << bits) - 1) : 0;
+	tab->age = 0;
+	return tab->ent != NULL;
+}
+
+int tt_fit(const u64 bytes)
+{
+	int bits;
+
+	for(bits = TT_BITS; bits >= TT_MIN_BITS; bits--)
+		if(((u64)1 << bits) * sizeof(tentry_t) <= bytes)
+			return bits;
+	return 0;
+}
+
+void tt_free(ttable_t* tab)
+{
+	free(tab->ent);
+	tab->ent = NULL;
+	tab->mask = 0;
+}
+
+void tt_clear(ttable_t* tab)
+{
+	if(tab->ent != NULL)
+		memset(tab->ent, 0, ((size_t)tab->mask + 1) * sizeof(tentry_t));
+}
+
+void tt_new_search(ttable_t* tab)
+{
+	u32 i;
+
+	tab->age++;
+
+	// only the current age is told apart, so older entries become one search
+	// old before the age wraps around to them
+	if(tab->age % TT_AGE_SWEEP == 0)
+		for(i = 0; tab->ent != NULL && i <= tab->mask; i++)
+			tab->ent[i].age = (u8)(tab->age - 1);
+}
+
+const tentry_t* tt_probe(const ttable_t* tab, const u64 key)
+{
+	const tentry_t* b;
+
+	if(tab->ent == NULL)
+		return NULL;
+	b = bucket(tab, key);
+	if(b[0].key == key)
+		return &b[0];
+	if(b[1].key == key)
+		return &b[1];
+	return NULL;
+}
+
+void tt_store(ttable_t* tab, const u64 key, const long score, const u8 dep,
+				const u8 bound, const u8 best)
+{
+	if(tab->ent != NULL)
+		store(tab, key, score, dep, bound, best, tab->age);
+}
+
+bool tt_save(const ttable_t* tab, const char* dir, const u8 mindep)
+{
+	thead_t head;
+	FILE* fout;
+	u32 i;
+	bool ok = true;
+
+	memset(&head, 0, sizeof(head));
+	head.magic = TT_MAGIC;
+	head.version = TT_VERSION;
+	for(i = 0; tab->ent != NULL && i <= tab->mask; i++)
+		if(tab->ent[i].key != 0 && tab->ent[i].dep >= mindep)
+			head.num++;
+
+	if((fout = fopen(dir, "wb")) == NULL)
+		return false;
+	ok = fwrite(&head, sizeof(head), 1, fout) == 1;
+	for(i = 0; ok && tab->ent != NULL && i <= tab->mask; i++)
+		if(tab->ent[i].key != 0 && tab->ent[i].dep >= mindep)
+			ok = fwrite(&tab->ent[i], sizeof(tentry_t), 1, fout) == 1;
+	return fclose(fout) == 0 && ok;
+}
+
+u32 tt_load(ttable_t* tab, const char* dir)
+{
+	const thead_t* head;
+	const tentry_t* e;
+	const void* addr;
+	size_t size;
+	u32 i, num = 0;
+
+	if(tab->ent == NULL || !map_file(dir, &addr, &size))
+		return 0;
+
+	head = (const thead_t*)addr;
+	e = (const tentry_t*)(head + 1);
+	if(size >= sizeof(thead_t) && head->magic == TT_MAGIC && head->version == TT_VERSION
+	&& head->num == (size - sizeof(thead_t)) / sizeof(tentry_t))
+	{
+		for(i = 0; i < head->num; i++)
+		{
+			if(e[i].key == 0 || e[i].bound > TT_UPPER
+			|| (e[i].best >= 15 * 15 && e[i].best != INVALID))
+				continue;
+			store(tab, e[i].key, e[i].score, e[i].dep, e[i].bound, e[i].best,
+					(u8)(tab->age - 1));
+			num++;
+		}
+	}
+
+	unmap_file(addr, size);
+	return num;
+}
@@ -0,0 +1,114 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * ttable.h - transposition table kept across searches
+ *
+ * Every heuristic() starts a new age. Entries of older ages are replaced
+ * first, so the table keeps the analysis of earlier moves and games until
+ * newer results need the room. Every 128 searches all entries are made one
+ * search old, so the 8-bit age never wraps around to an old entry. The
+ * deeper entries can be saved to a file of learned positions and merged back
+ * from it on startup.
+ *
+ * A table is used by one search at a time.
+ */
+
+#ifndef __TTABLE_H__
+#define __TTABLE_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include "macro.h"
+
+#define TT_BITS			20		// default table has 2^TT_BITS entries
+#define TT_MIN_BITS		10		// smaller tables aren't worth keeping
+#define TT_SAVE_DEP		4		// minimum depth of the saved entries
+
+// learned positions loaded at startup
+#define TT_FILE			"opening/learned.bin"
+
+// bound of a score
+#define TT_EXACT		0
+#define TT_LOWER		1		// the score is at least this
+#define TT_UPPER		2		// the score is at most this
+
+// table entry, empty if key is 0
+typedef struct {
+	u64 key;			// salted hash of the position
+	int32_t score;		// score for the searching side
+	u8 dep;				// remaining depth searched
+	u8 bound;			// TT_EXACT, TT_LOWER or TT_UPPER
+	u8 best;			// best move, INVALID if none
+	u8 age;				// age of the search storing it, only compared with
+						// the current age
+} tentry_t;
+
+typedef struct {
+	tentry_t* ent;		// buckets of two entries
+	u32 mask;			// entry number - 1
+	u8 age;				// age of the current search
+} ttable_t;
+
+/*
+ * Allocate an empty table of 2^bits entries.
+ * Return false if out of memory, the table is left empty.
+ */
+bool tt_init(ttable_t* tab, const int bits);
+
+/*
+ * Return the largest bits up to TT_BITS of a table fitting in bytes, 0 if
+ * not even 2^TT_MIN_BITS entries fit.
+ */
+int tt_fit(const u64 bytes);
+
+/*
+ * Free the entries of a table.
+ */
+void tt_free(ttable_t* tab);
+
+/*
+ * Forget all entries.
+ */
+void tt_clear(ttable_t* tab);
+
+/*
+ * Start a new age, the entries stored so far become replaceable.
+ */
+void tt_new_search(ttable_t* tab);
+
+/*
+ * Return the entry of key or NULL.
+ */
+const tentry_t* tt_probe(const ttable_t* tab, const u64 key);
+
+/*
+ * Store a search result. Within a bucket, the entry of key, an entry of an
+ * older age or the shallower entry is replaced.
+ */
+void tt_store(ttable_t* tab, const u64 key, const long score, const u8 dep,
+				const u8 bound, const u8 best);
+
+/*
+ * Write the entries searched to at least mindep into file dir.
+ * Return false if the file can't be written.
+ */
+bool tt_save(const ttable_t* tab, const char* dir, const u8 mindep);
+
+/*
+ * Merge the entries of a file written by tt_save() as entries of an older
+ * age. Return the # of entries read, 0 if the file is missing or broken.
+ */
+u32 tt_load(ttable_t* tab, const char* dir);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
+
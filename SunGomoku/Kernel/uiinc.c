@@ -10,56 +10,164 @@
 
 #include "uiinc.h"
 #include "macro.h"
+#include "thread.h"
 #include "board.h"
+#include "hash.h"
 #include "search.h"
 #include "book.h"
+#include "profile.h"
+#include "ttable.h"
 
 extern bool isForbidden;
 
 static board_t Board;
+static double InitTime = 0.0;
+static channel_t Progress;		// ai_do_move() to the ui thread
+static ttable_t Table;			// kept across moves and games
+static int TableBits = 0;		// table size, 0 if there is no table
+static size_t BookSize = 0;		// bytes of the book closed by memory_fit()
 
-search_t Srh = {
-	.sc = {
-		.win = WIN,
-		.lose = LOSE,
-		.free4 = 4320,
-		.dead4 = 882,
-		.free3 = 630,
-		.dead3 = 294,
-		.free2 = 210,
-		.dead2 = 42,
-		.free1 = 30,
-		.dead1 = 1,
-		.free3a = 693,
-		.free2a = 231,
-		.free1a = 33
-	},
-	.me = BLACK,
-	.opp = WHITE,
-	.leaf = 10,
-	.dep = 10,
-	.presrh = true,
-	.book = true
-};
+// limits set by the caller, the tighter of them and those of the profile
+// are used
+static u64 NodeLimit = 0;
+static u32 TimeLimit = 0;
+static u32 MemoryLimit = 0;
+
+// match clock of the next ai_do_move()
+static u32 MatchLeft = 0;
+static u32 MatchInc = 0;
+
+// background initialization
+static thread_t InitThread;
+static bool InitStarted = false;
+static volatile int Ready = 0;
+static void (*ReadyCallback)(void*) = NULL;
+static void* ReadyArg = NULL;
+
+search_t Srh;
 
 void initialize()
 {
+	double start = wall_time();
+	int threads = cpu_count();
+
 	srand(time(0));
+	hash_init();
 	nei_table_init();
-	pattern_table_init1();
-	pattern_table_init2();
+	pattern_table_init(threads);
+	InitTime = wall_time() - start;
+	fprintf(stderr, "tables built in %.2f s with %d threads\n", InitTime, threads);
+
+	profile_load("profiles.ini");
+	Srh = profile_find("hard")->srh;
+
+	// the .lib books are merged here without a compiled book
+	book_open(BOOK_FILE);
+
+	// the table survives rule changes, its keys are salted with the rule
+	if(Table.ent == NULL && tt_init(&Table, TT_BITS))
+	{
+		TableBits = TT_BITS;
+		tt_load(&Table, TT_FILE);
+	}
+}
+
+// return the tighter of two limits, 0 for none
+static u64 tighter(const u64 a, const u64 b)
+{
+	if(a == 0 || (b > 0 && b < a))
+		return b;
+	return a;
+}
+
+// fit the book and the table in megabytes, 0 for no limit, besides the
+// evaluation cache of the searching thread. The book is closed while it
+// alone is too large and opened again once a later limit has room for it,
+// the table is resized and loses its entries.
+static void memory_fit(const u32 megabytes)
+{
+	u64 budget = (u64)megabytes << 20;
+	int bits = TT_BITS;
+
+	budget = budget > search_eval_memory() ? budget - search_eval_memory() : 0;
+
+	if(megabytes > 0 && book_memory() > budget)
+	{
+		BookSize = book_memory();
+		book_close();
+	}
+	else if(BookSize > 0 && (megabytes == 0 || BookSize <= budget))
+	{
+		BookSize = 0;
+		book_open(BOOK_FILE);
+	}
+
+	if(megabytes > 0)
+		bits = tt_fit(budget - book_memory());
+
+	if(bits != TableBits)
+	{
+		tt_free(&Table);
+		TableBits = bits > 0 && tt_init(&Table, bits) ? bits : 0;
+	}
+}
+
+static void* init_worker(void* arg)
+{
+	(void)arg;
+
+	initialize();
+	Ready = 1;
+	if(ReadyCallback != NULL)
+		ReadyCallback(ReadyArg);
+	return NULL;
+}
+
+void initialize_async(void (*callback)(void*), void* arg)
+{
+	// tables built again for another rule wait for the last build
+	if(InitStarted)
+	{
+		thread_join(InitThread);
+		InitStarted = false;
+	}
+	Ready = 0;
+
+	ReadyCallback = callback;
+	ReadyArg = arg;
+	InitStarted = thread_create(&InitThread, init_worker, NULL);
+
+	// build on the calling thread if no thread can be started
+	if(!InitStarted)
+		init_worker(NULL);
+}
+
+int engine_ready()
+{
+	return Ready;
+}
+
+double get_init_time()
+{
+	return InitTime;
 }
 
 void restart()
 {
 	board_reset(&Board);
-	if(book_isload())
-		book_reset();
 }
 
 void uninitialize()
 {
-	book_delete();
+	if(InitStarted)
+	{
+		thread_join(InitThread);
+		InitStarted = false;
+	}
+	book_close();
+	BookSize = 0;
+	tt_free(&Table);
+	TableBits = 0;
 }
 
 void set_forbidden(const int flag)
@@ -70,48 +178,48 @@ void set_forbidden(const int flag)
 		isForbidden = false;
 }
 
+int get_forbidden()
+{
+	return isForbidden;
+}
+
 void set_difficulty(const int dif)
 {
+	if(dif < 0 || dif > 2)
+		return;
+
+	// built-in profiles are ordered by rule and difficulty
 	if(isForbidden)
-	{
-		switch(dif)
-		{
-			case 0:
-				Srh.dep = 4;
-				Srh.book = false;
-				break;
-			case 1:
-				Srh.dep = 8;
-				Srh.book = false;
-				break;
-			case 2:
-				Srh.dep = 10;
-				Srh.book = true;
-				break;
-			default:
-				break;
-		}
-	}
+		Srh = profile_get(dif)->srh;
 	else
-	{
-		switch(dif)
-		{
-			case 0:
-				Srh.dep = 1;
-				Srh.book = false;
-				break;
-			case 1:
-				Srh.dep = 2;
-				Srh.book = false;
-				break;
-			case 2:
-				Srh.dep = 4;
-				Srh.book = false;
-				break;
-			default:
-				break;
-		}
-	}
+		Srh = profile_get(dif + 3)->srh;
+}
+
+int load_profiles(const char* dir)
+{
+	return profile_load(dir);
+}
+
+int get_profile_num()
+{
+	return profile_num();
+}
+
+const char* get_profile_name(const int i)
+{
+	const profile_t* pro = profile_get(i);
+	if(pro == NULL)
+		return NULL;
+	return pro->name;
+}
+
+int set_profile(const char* name)
+{
+	const profile_t* pro = profile_find(name);
+	if(pro == NULL)
+		return 0;
+	Srh = pro->srh;
+	return 1;
 }
 
 void player_do_move(const int x, const int y, int* isover, const u8 color)
@@ -120,8 +228,30 @@ void player_do_move(const int x, const int y, int* isover, const u8 color)
 	*isover = board_gameover(&Board);
 }
 
+void set_node_limit(const long nodes)
+{
+	NodeLimit = nodes > 0 ? nodes : 0;
+}
+
+void set_time_limit(const long msec)
+{
+	TimeLimit = msec > 0 ? msec : 0;
+}
+
+void set_memory_limit(const long megabytes)
+{
+	MemoryLimit = megabytes > 0 ? megabytes : 0;
+}
+
+void set_match_clock(const long left, const long inc)
+{
+	MatchLeft = left > 0 ? left : 0;
+	MatchInc = inc > 0 ? inc : 0;
+}
+
 int ai_do_move(int* isover, const u8 color)
 {
+	search_t srh;
 	int pos;
 
 	if(color == BLACK)
@@ -135,13 +265,59 @@ int ai_do_move(int* isover, const u8 color)
 		Srh.opp = BLACK;
 	}
 
-	pos = heuristic(&Board, &Srh);
+	srh = Srh;
+	srh.nodes = tighter(Srh.nodes, NodeLimit);
+	srh.time = tighter(Srh.time, TimeLimit);
+	srh.memory = tighter(Srh.memory, MemoryLimit);
+	srh.left = MatchLeft;
+	srh.inc = MatchInc;
+	memory_fit(srh.memory);
+
+	search_channel(&Progress);
+	search_table(TableBits > 0 ? &Table : NULL);
+	pos = heuristic(&Board, &srh);
+	search_table(NULL);
+	search_channel(NULL);
+	if(search_aborted())
+	{
+		*isover = false;
+		return -1;
+	}
 	do_move(&Board, pos, color);
 	*isover = board_gameover(&Board);
 
 	return pos;
 }
 
+int poll_progress(progress_t* info)
+{
+	int got = 0;
+
+	while(channel_pop(&Progress, info))
+		got = 1;
+	return got;
+}
+
+int save_table(const char* dir)
+{
+	return tt_save(&Table, dir, TT_SAVE_DEP);
+}
+
+int load_table(const char* dir)
+{
+	return tt_load(&Table, dir) > 0;
+}
+
+void clear_table()
+{
+	tt_clear(&Table);
+}
+
+void abort_search(const int flag)
+{
+	search_abort(flag != 0);
+}
+
 void undo_move(const int N)
 {
 	int i;
@@ -18,12 +18,33 @@ extern "C" {
 #endif
 
 #include "macro.h"
+#include "progress.h"
 
 /*
  * Call this functions at the beginning of the program.
  */
 void initialize();
 
+/*
+ * Call initialize() on a background thread and return at once.
+ * callback(arg) is called on that thread when the engine is ready. It may be
+ * NULL. No other function but engine_ready() and uninitialize() may be called
+ * before that. It may be called again to build the tables for another rule.
+ *
+ * Usage: initialize_async(on_ready, window);
+ */
+void initialize_async(void (*callback)(void*), void* arg);
+
+/*
+ * Return 1 if initialization has finished. Else return 0.
+ */
+int engine_ready();
+
+/*
+ * Return the seconds initialize() took to build the lookup tables.
+ */
+double get_init_time();
+
 /*
  * Call this function at the beginning of each round.
  */
@@ -31,6 +52,7 @@ void restart();
 
 /*
  * Call this function at the end of the program.
+ * It waits for initialize_async() to finish.
  */
 void uninitialize();
 
@@ -42,6 +64,11 @@ void uninitialize();
  */
 void set_forbidden(const int flag);
 
+/*
+ * Return 1 if forbidden points are considered. Else return 0.
+ */
+int get_forbidden();
+
 /*
  * Set game difficulty.
  *
@@ -51,6 +78,60 @@ void set_forbidden(const int flag);
  */
 void set_difficulty(const int dif);
 
+/*
+ * Load engine profiles from a file, see profile.h for the format.
+ * initialize() already loads "profiles.ini" if it exists.
+ * A loaded profile replaces the one with the same name.
+ *
+ * Return 1 if succeeds. Else return 0.
+ */
+int load_profiles(const char* dir);
+
+/*
+ * Return the number of profiles.
+ * The first six are built in: novice, normal, hard, free-novice, free-normal
+ * and free-hard, as used by set_difficulty().
+ */
+int get_profile_num();
+
+/*
+ * Return the name of the i-th profile or NULL if no such profile.
+ */
+const char* get_profile_name(const int i);
+
+/*
+ * Use a named profile for the following games.
+ *
+ * Usage: set_profile("hard");
+ *
+ * Return 1 if succeeds. Else return 0.
+ */
+int set_profile(const char* name);
+
+/*
+ * Limit the searches of ai_do_move(), 0 for no limit. A search hitting its
+ * node or time limit plays the best move found so far. The memory limit
+ * covers the evaluation cache, the transposition table and the opening book,
+ * which is closed while it alone is too large and opened again once a limit
+ * leaves room for it.
+ * The tighter of these and the limits of the profile are used.
+ *
+ * Usage: set_time_limit(5000);		// 5 seconds per move
+ *		  set_memory_limit(64);		// 64 megabytes
+ */
+void set_node_limit(const long nodes);
+void set_time_limit(const long msec);
+void set_memory_limit(const long megabytes);
+
+/*
+ * Set the match clock of ai_do_move(): the remaining match time and the time
+ * added per move, both in milliseconds. The time of a move is then planned
+ * from them, within the limits above. left 0 turns the clock off.
+ *
+ * Usage: set_match_clock(180000, 2000);	// 3 minutes plus 2 seconds a move
+ */
+void set_match_clock(const long left, const long inc);
+
 /*
  * Do player's move.
  *
@@ -73,7 +154,8 @@ void player_do_move(const int x, const int y, int* isover, const u8 color);
  * @param [out]	isvoer	Set to BLACK(1) if black wins. Set to WHITE(2) if white wins.
  *						Set to DRAW(225) if draws. Else set to false(0).
  *
- * Return	The position ai moves.
+ * Return	The position ai moves, or -1 if the search is aborted. Then the
+ *			board is left unchanged.
  *
  * Usage:	int pos = ai_do_move(&isover, BLACK);
  *			if(isover == BLACK)	black_win();
@@ -84,6 +166,47 @@ void player_do_move(const int x, const int y, int* isover, const u8 color);
  */
 int ai_do_move(int* isover, const u8 color);
 
+/*
+ * Get the latest progress of an ai_do_move() running on another thread,
+ * older snapshots are discarded. Call it from one thread only.
+ *
+ * Return 1 if there is a new snapshot. Else return 0.
+ */
+int poll_progress(progress_t* info);
+
+/*
+ * Save the positions searched to some depth as learned positions.
+ * initialize() merges "opening/learned.bin" if it exists.
+ *
+ * Usage: save_table("opening/learned.bin");
+ *
+ * Return 1 if succeeds. Else return 0.
+ */
+int save_table(const char* dir);
+
+/*
+ * Merge learned positions saved by save_table().
+ *
+ * Return 1 if any position is read. Else return 0.
+ */
+int load_table(const char* dir);
+
+/*
+ * Forget the positions searched so far, ai_do_move() keeps them across moves
+ * and restart() otherwise.
+ */
+void clear_table();
+
+/*
+ * Abort an ai_do_move() running on another thread, or clear the request.
+ * ai_do_move() returns at once while the flag is set.
+ *
+ * Usage:	abort_search(1);
+ *			wait_for_the_search_thread();
+ *			abort_search(0);
+ */
+void abort_search(const int flag);
+
 /*
  * Undo N moves.
  */
@@ -9,7 +9,7 @@ ICON      = Resources/SunGomokuMac.icns
 RC_ICONS  = Resources/SunGomokuWin.ico
 
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 TARGET = SunGomoku
 TEMPLATE = app
@@ -27,31 +27,51 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 CONFIG += c++11
 
+# kernel threads
+unix: LIBS += -lpthread
+
 SOURCES += \
         main.cpp \
     xrUI/chessboard.cpp \
     xrUI/xrhall.cpp \
     xrUI/xrroom.cpp \
+    xrUI/xrengine.cpp \
     Kernel/board.c \
     Kernel/book.c \
+    Kernel/hash.c \
+    Kernel/mapfile.c \
+    Kernel/profile.c \
+    Kernel/progress.c \
+    Kernel/renju.c \
     Kernel/search.c \
+    Kernel/thread.c \
+    Kernel/timeman.c \
     Kernel/tree.c \
+    Kernel/ttable.c \
     Kernel/uiinc.c \
     xrUI/xrtemp.cpp
 
 HEADERS += \
     Kernel/board.h \
     Kernel/book.h \
-    Kernel/key.h \
+    Kernel/hash.h \
     Kernel/macro.h \
+    Kernel/mapfile.h \
     Kernel/mvlist.h \
     Kernel/pattern.h \
+    Kernel/profile.h \
+    Kernel/progress.h \
+    Kernel/renju.h \
     Kernel/search.h \
+    Kernel/thread.h \
+    Kernel/timeman.h \
     Kernel/tree.h \
+    Kernel/ttable.h \
     Kernel/uiinc.h \
     xrUI/chessboard.h \
     xrUI/xrhall.h \
     xrUI/xrroom.h \
+    xrUI/xrengine.h \
     xrUI/xrtemp.h
 
 FORMS += \
@@ -0,0 +1,165 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * bench.c - search a fixed set of positions and report nodes and time
+ *
+ * Usage: sgbench [-p profiles] [-c config] [-r rule] [-g file] [-t bits]
+ *
+ *	-p		Load engine profiles from this file.
+ *	-c		Engine configuration, e.g. "normal,adapt=0". Default is hard.
+ *	-r		1 to consider forbidden points, 0 to neglect them.
+ *	-g		Also search every tenth position of the games in this file.
+ *	-t		Keep a transposition table of 2^bits entries across the positions.
+ *
+ * The benchmark set is the opening suite of sgmatch, searched for white.
+ */
+
+#include "tools.h"
+#include "Kernel/macro.h"
+#include "Kernel/board.h"
+#include "Kernel/search.h"
+#include "Kernel/uiinc.h"
+#include "Kernel/profile.h"
+#include "Kernel/ttable.h"
+
+#define GAME_STEP	10
+
+extern bool isForbidden;
+
+static search_t Eng;
+static ttable_t Table;
+static u64 TotalNodes = 0;
+static u64 TotalProbes = 0;
+static u64 TotalHits = 0;
+static double TotalTime = 0.0;
+static int Count = 0;
+
+// search the position of bd for color
+static void bench_position(board_t* bd, const u8 color)
+{
+	clock_t start;
+	double sec;
+	u64 probes, hits;
+	u8 pos;
+
+	Eng.me = color;
+	Eng.opp = BLACK + WHITE - color;
+
+	start = clock();
+	pos = heuristic(bd, &Eng);
+	sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	search_eval_stats(&probes, &hits);
+	TotalNodes += search_nodes();
+	TotalProbes += probes;
+	TotalHits += hits;
+	TotalTime += sec;
+	Count++;
+
+	printf("position %3d  move %3d  nodes %10llu  time %7.3f\n",
+			Count, pos, (unsigned long long)search_nodes(), sec);
+	fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+	board_t* bd;
+	u8 suite[SUITE_NUM][3];
+	char* conf = "";
+	char* games = NULL;
+	int bits = 0;
+	FILE* fin;
+	game_t game;
+	int i, j, num;
+
+	for(i = 1; i + 1 < argc; i += 2)
+	{
+		if(!strcmp(argv[i], "-p"))
+		{
+			if(!profile_load(argv[i + 1]))
+			{
+				printf("can't load profiles!\n");
+				return 1;
+			}
+		}
+		else if(!strcmp(argv[i], "-c"))
+			conf = argv[i + 1];
+		else if(!strcmp(argv[i], "-r"))
+			isForbidden = atoi(argv[i + 1]) != 0;
+		else if(!strcmp(argv[i], "-g"))
+			games = argv[i + 1];
+		else if(!strcmp(argv[i], "-t"))
+			bits = atoi(argv[i + 1]);
+		else
+			break;
+	}
+
+	Eng = profile_find("hard")->srh;
+	if(i != argc || !config_parse(&Eng, conf) || bits < 0 || bits > 30)
+	{
+		printf("usage: sgbench [-p profiles] [-c config] [-r rule] [-g file] [-t bits]\n");
+		return 1;
+	}
+
+	// book moves would skip the searches being measured
+	Eng.book = false;
+
+	// pattern tables depend on isForbidden so it is set before
+	initialize();
+	bd = (board_t*)malloc(sizeof(board_t));
+	if(bits > 0)
+	{
+		if(!tt_init(&Table, bits))
+		{
+			printf("can't allocate the table!\n");
+			return 1;
+		}
+		search_table(&Table);
+	}
+
+	num = opening_suite(suite);
+	for(i = 0; i < num; i++)
+	{
+		board_reset(bd);
+		for(j = 0; j < 3; j++)
+			do_move(bd, suite[i][j], j % 2 ? WHITE : BLACK);
+		bench_position(bd, WHITE);
+	}
+
+	if(games != NULL)
+	{
+		if((fin = fopen(games, "rb")) == NULL)
+		{
+			printf("can't open game file!\n");
+			return 1;
+		}
+		while(game_read(fin, &game))
+		{
+			if(game.rule != isForbidden)
+				continue;
+			board_reset(bd);
+			for(j = 0; j + 1 < game.num; j++)
+			{
+				do_move(bd, game.moves[j], j % 2 ? WHITE : BLACK);
+				if((j + 1) % GAME_STEP == 0)
+					bench_position(bd, j % 2 ? BLACK : WHITE);
+			}
+		}
+		fclose(fin);
+	}
+
+	printf("\n%d positions  nodes %llu  time %.3f  nps %.0f  eval hits %.1f%%\n", Count,
+			(unsigned long long)TotalNodes, TotalTime,
+			TotalTime > 0.0 ? TotalNodes / TotalTime : 0.0,
+			TotalProbes > 0 ? 100.0 * TotalHits / TotalProbes : 0.0);
+
+	free(bd);
+	tt_free(&Table);
+	uninitialize();
+	return 0;
+}
+
@@ -0,0 +1,13 @@
+#-------------------------------------------------
+#
+# Search benchmark over a fixed set of positions
+#
+#-------------------------------------------------
+
+TARGET = sgbench
+TEMPLATE = app
+
+include(kernel.pri)
+
+SOURCES += \
+    bench.c
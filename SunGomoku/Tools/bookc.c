@@ -0,0 +1,62 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * bookc.c - compile the opening books into one flat file
+ *
+ * Usage: sgbookc [-o file]
+ *
+ *	-o		Output file. Default is opening/book.bin.
+ *
+ * Run it in the directory holding opening/, like the engine. The positions
+ * analyzed by sgbookgen in opening/analysis.txt are merged too if present.
+ * The engine maps the output at startup instead of loading a .lib book for
+ * every game.
+ */
+
+#include "tools.h"
+#include "Kernel/macro.h"
+#include "Kernel/book.h"
+
+static void usage()
+{
+	printf("usage: sgbookc [-o file]\n");
+}
+
+int main(int argc, char* argv[])
+{
+	const char* dir = BOOK_FILE;
+	int i;
+
+	for(i = 1; i + 1 < argc; i += 2)
+	{
+		if(!strcmp(argv[i], "-o"))
+			dir = argv[i + 1];
+		else
+			break;
+	}
+	if(i != argc)
+	{
+		usage();
+		return 1;
+	}
+
+	if(!book_compile(dir))
+	{
+		printf("failed to compile books into %s\n", dir);
+		return 1;
+	}
+
+	// the engine rejects a broken file, check it the same way
+	if(!book_verify(dir))
+	{
+		printf("compiled book %s is unreadable\n", dir);
+		return 1;
+	}
+
+	printf("compiled books into %s\n", dir);
+	return 0;
+}
@@ -0,0 +1,13 @@
+#-------------------------------------------------
+#
+# Opening book compiler
+#
+#-------------------------------------------------
+
+TARGET = sgbookc
+TEMPLATE = app
+
+include(kernel.pri)
+
+SOURCES += \
+    bookc.c
@@ -0,0 +1,320 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * bookgen.c - extend the opening book with deep searches of early positions
+ *
+ * Usage: sgbookgen [-p profiles] [-c config] [-n plies] [-w width]
+ *                  [-m margin] [-t threads] [-r rule] [-o file]
+ *
+ *	-p		Load engine profiles from this file.
+ *	-c		Engine configuration of the searches. Default is hard.
+ *	-n		Analyze positions with up to this many discs. Default is 4.
+ *	-w		Expand the best move and this many heuristic moves of every
+ *			position. Default is 4.
+ *	-m		Don't expand positions whose score is beyond +- margin.
+ *			Default is 3000.
+ *	-t		Number of threads. Default is the number of processors.
+ *	-r		1 or 0 to analyze one rule only. Default is both.
+ *	-o		Output file. Default is opening/analysis.txt.
+ *
+ * Positions grow one disc per level from H8, so both colors get book moves.
+ * Every position of a level is searched on the threads. Only balanced
+ * positions are expanded, with their best move and the heuristic's first
+ * moves, and transpositions and symmetric positions are searched once.
+ *
+ * Each output line is "rule depth score best num moves...", see book.c.
+ * sgbookc merges the file with the .lib books.
+ */
+
+#include "tools.h"
+#include "Kernel/macro.h"
+#include "Kernel/thread.h"
+#include "Kernel/board.h"
+#include "Kernel/book.h"
+#include "Kernel/search.h"
+#include "Kernel/uiinc.h"
+#include "Kernel/profile.h"
+
+#define PLY_MAX		32
+
+extern bool isForbidden;
+
+// analyzed position
+typedef struct {
+	u8 moves[PLY_MAX];
+	u8 num;
+	u8 best;
+	long score;
+} entry_t;
+
+static search_t Eng;
+static int Threads;
+
+// positions of the current level
+static entry_t* Level = NULL;
+static int LevelNum = 0;
+
+// canonical hashes of the positions already queued, at most half full
+static u64* Seen = NULL;
+static u32 SeenSize = 0;
+static u32 SeenNum = 0;
+
+static void seen_reset(const u32 size)
+{
+	free(Seen);
+	Seen = (u64*)calloc(size, sizeof(u64));
+	SeenSize = size;
+	SeenNum = 0;
+}
+
+// return false if the key is already in Seen
+static bool seen_insert(const u64 key)
+{
+	u64* old = Seen;
+	u32 i, size = SeenSize;
+
+	if(2 * (SeenNum + 1) > SeenSize)
+	{
+		Seen = NULL;
+		seen_reset(2 * size);
+		for(i = 0; i < size; i++)
+			if(old[i])
+				seen_insert(old[i]);
+		free(old);
+	}
+
+	for(i = key & (SeenSize - 1); Seen[i]; i = (i + 1) & (SeenSize - 1))
+		if(Seen[i] == key)
+			return false;
+	Seen[i] = key;
+	SeenNum++;
+	return true;
+}
+
+static void board_set(board_t* bd, const entry_t* e)
+{
+	int i;
+
+	board_reset(bd);
+	for(i = 0; i < e->num; i++)
+		do_move(bd, e->moves[i], i % 2 ? WHITE : BLACK);
+}
+
+// search the positions of the level taken round-robin by thread id
+static void* search_worker(void* arg)
+{
+	board_t* bd = (board_t*)malloc(sizeof(board_t));
+	search_t srh = Eng;
+	int i;
+
+	for(i = (int)(intptr_t)arg; i < LevelNum; i += Threads)
+	{
+		board_set(bd, &Level[i]);
+		srh.me = Level[i].num % 2 ? WHITE : BLACK;
+		srh.opp = BLACK + WHITE - srh.me;
+		srh.book = false;
+
+		Level[i].best = heuristic(bd, &srh);
+		Level[i].score = search_score();
+	}
+
+	free(bd);
+	return NULL;
+}
+
+static void search_level()
+{
+	thread_t tid[64];
+	bool started[64];
+	int i, num = Threads < 64 ? Threads : 64;
+
+	// positions of threads that fail to start are searched here
+	for(i = 1; i < num; i++)
+		started[i] = thread_create(&tid[i], search_worker, (void*)(intptr_t)i);
+	search_worker((void*)(intptr_t)0);
+	for(i = 1; i < num; i++)
+	{
+		if(started[i])
+			thread_join(tid[i]);
+		else
+			search_worker((void*)(intptr_t)i);
+	}
+}
+
+static void add_child(entry_t** next, int* num, int* cap, const entry_t* e, const u8 pos)
+{
+	if(*num == *cap)
+	{
+		*cap = *cap ? *cap * 2 : 64;
+		*next = (entry_t*)realloc(*next, *cap * sizeof(entry_t));
+	}
+	(*next)[*num] = *e;
+	(*next)[*num].moves[e->num] = pos;
+	(*next)[*num].num = e->num + 1;
+	(*num)++;
+}
+
+/*
+ * Build the next level from the balanced positions of the current one.
+ */
+static void expand_level(board_t* bd, const int width, const long margin)
+{
+	entry_t* next = NULL;
+	u8 cand[15 * 15];
+	u8 pos, color;
+	int i, j, k, num = 0, cap = 0;
+
+	for(i = 0; i < LevelNum; i++)
+	{
+		if(Level[i].best >= 15 * 15 || labs(Level[i].score) > margin)
+			continue;
+
+		board_set(bd, &Level[i]);
+		color = Level[i].num % 2 ? WHITE : BLACK;
+
+		// the best move, then the first moves of the heuristic
+		k = 0;
+		cand[k++] = Level[i].best;
+		heuristic_generate(bd, &Eng, Eng.dep, color, BLACK + WHITE - color);
+		pos = mvlist_first(hlist(bd));
+		for(j = 0; j < width && pos != END; j++)
+		{
+			if(pos != Level[i].best)
+				cand[k++] = pos;
+			pos = mvlist_next(hlist(bd), pos);
+		}
+
+		for(j = 0; j < k; j++)
+		{
+			do_move(bd, cand[j], color);
+			if(!board_gameover(bd) && seen_insert(board_hash(bd, NULL)))
+				add_child(&next, &num, &cap, &Level[i], cand[j]);
+			undo(bd);
+		}
+	}
+
+	free(Level);
+	Level = next;
+	LevelNum = num;
+}
+
+static void usage()
+{
+	printf("usage: sgbookgen [-p profiles] [-c config] [-n plies] [-w width]\n"
+		   "                 [-m margin] [-t threads] [-r rule] [-o file]\n");
+}
+
+int main(int argc, char* argv[])
+{
+	board_t* bd;
+	FILE* fout;
+	char* conf = "";
+	const char* dir = BOOK_ANALYSIS;
+	int plies = 4, width = 4, rule = -1;
+	int i, j, r, ply, total;
+	long margin = 3000;
+	double start;
+
+	Threads = cpu_count();
+	for(i = 1; i + 1 < argc; i += 2)
+	{
+		if(!strcmp(argv[i], "-p"))
+		{
+			if(!profile_load(argv[i + 1]))
+			{
+				printf("can't load profiles!\n");
+				return 1;
+			}
+		}
+		else if(!strcmp(argv[i], "-c"))
+			conf = argv[i + 1];
+		else if(!strcmp(argv[i], "-n"))
+			plies = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-w"))
+			width = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-m"))
+			margin = atol(argv[i + 1]);
+		else if(!strcmp(argv[i], "-t"))
+			Threads = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-r"))
+			rule = atoi(argv[i + 1]) != 0;
+		else if(!strcmp(argv[i], "-o"))
+			dir = argv[i + 1];
+		else
+			break;
+	}
+
+	Eng = profile_find("hard")->srh;
+	if(i != argc || plies < 1 || plies > PLY_MAX || width < 0 || Threads <= 0
+	|| !config_parse(&Eng, conf))
+	{
+		usage();
+		return 1;
+	}
+
+	if((fout = fopen(dir, "w")) == NULL)
+	{
+		printf("can't open %s!\n", dir);
+		return 1;
+	}
+	bd = (board_t*)malloc(sizeof(board_t));
+
+	for(r = 1; r >= 0; r--)
+	{
+		if(rule >= 0 && r != rule)
+			continue;
+
+		// pattern tables depend on the rule
+		set_forbidden(r);
+		initialize();
+
+		seen_reset(1024);
+
+		Level = (entry_t*)malloc(sizeof(entry_t));
+		Level[0].moves[0] = 112;
+		Level[0].num = 1;
+		LevelNum = 1;
+		total = 0;
+
+		for(ply = 1; ply <= plies && LevelNum > 0; ply++)
+		{
+			start = wall_time();
+			search_level();
+
+			for(i = 0; i < LevelNum; i++)
+			{
+				if(Level[i].best >= 15 * 15)
+					continue;
+				fprintf(fout, "%d %d %ld %d %d", r, Eng.dep, Level[i].score,
+						Level[i].best, Level[i].num);
+				for(j = 0; j < Level[i].num; j++)
+					fprintf(fout, " %d", Level[i].moves[j]);
+				fputc('\n', fout);
+			}
+			fflush(fout);
+			total += LevelNum;
+
+			printf("rule %d  discs %d  positions %d  time %.1f\n",
+					r, ply, LevelNum, wall_time() - start);
+			fflush(stdout);
+
+			if(ply < plies)
+				expand_level(bd, width, margin);
+		}
+
+		printf("rule %d  %d positions analyzed\n", r, total);
+		free(Level);
+		Level = NULL;
+		LevelNum = 0;
+	}
+
+	fclose(fout);
+	free(Seen);
+	free(bd);
+	uninitialize();
+	return 0;
+}
@@ -0,0 +1,13 @@
+#-------------------------------------------------
+#
+# Opening book analysis of early positions
+#
+#-------------------------------------------------
+
+TARGET = sgbookgen
+TEMPLATE = app
+
+include(kernel.pri)
+
+SOURCES += \
+    bookgen.c
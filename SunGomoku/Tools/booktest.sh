@@ -0,0 +1,44 @@
+#!/bin/sh
+#                      _______
+#   Gomoku Engine     / _____/
+#                    / /______  ________
+#   developed by    /____  / / / / __  /
+#                  _____/ / /_/ / / / /
+#   2019.1        /______/_____/_/ /_/
+#
+# booktest.sh - check that sgengine stays in the opening book over a game
+#
+# Usage: booktest.sh sgengine
+#
+# The engine runs in a scratch directory whose only book is an analysis file
+# with one line of black moves to the corners, which no search would play.
+# Every search of sgengine runs on a new thread, so the book state must come
+# with the game. Prints OK and exits with 0 if all four book moves are played.
+
+ENGINE=${1:?usage: booktest.sh sgengine}
+case $ENGINE in
+	/*) ;;
+	*) ENGINE=$(pwd)/$ENGINE ;;
+esac
+
+DIR=$(mktemp -d) || exit 1
+trap 'rm -rf "$DIR"' EXIT
+mkdir "$DIR/opening"
+
+# rule dep score best num moves, black plays 112 and then the corners
+cat > "$DIR/opening/analysis.txt" <<EOF
+1 10 0 0 2 112 113
+1 10 0 14 4 112 113 0 96
+1 10 0 210 6 112 113 0 96 14 130
+1 10 0 224 8 112 113 0 96 14 130 210 50
+EOF
+
+GOT=$(cd "$DIR" && printf 'START 15\nBEGIN\nTURN 8,7\nTURN 6,6\nTURN 10,8\nTURN 5,3\nEND\n' \
+	| "$ENGINE" -r 1 2>/dev/null | grep -v '^MESSAGE' | tr '\n' ' ')
+WANT="OK 7,7 0,0 14,0 0,14 14,14 "
+
+if [ "$GOT" != "$WANT" ]; then
+	echo "FAILED: got '$GOT', want '$WANT'"
+	exit 1
+fi
+echo OK
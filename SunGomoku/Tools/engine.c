@@ -0,0 +1,400 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * engine.c - headless engine speaking the Gomocup protocol on stdin/stdout
+ *
+ * Usage: sgengine [-p profiles] [-r rule] [-l learned]
+ *
+ *	-p		Load engine profiles from this file.
+ *	-r		1 to consider forbidden points, 0 to neglect them.
+ *	-l		Merge learned positions from this file and save them back on END.
+ *
+ * Coordinates are "x,y" with x the column and y the row, both from 0.
+ *
+ *	START 15		Reply OK. Only the 15 * 15 board is supported.
+ *	RESTART			Start a new game, reply OK.
+ *	BEGIN			Search the first move, reply x,y.
+ *	TURN x,y		Play the opponent move and search, reply x,y.
+ *	BOARD			Set the position from the following "x,y,field" lines up to
+ *					DONE and search, reply x,y. Moves must be in playing order,
+ *					black first. A position extending the current game keeps
+ *					the opening book state.
+ *	TAKEBACK x,y	Take back the last move, reply OK.
+ *	INFO key value	Keys rule (bit 4 for renju), profile (a profile name),
+ *					timeout_turn (milliseconds, 0 to play at once),
+ *					timeout_match (milliseconds, 0 for no limit), time_left
+ *					(milliseconds), time_increment (milliseconds added to
+ *					the match time after every move, an extension, 0 by
+ *					default) and max_memory (bytes, 0 for no limit) are
+ *					used, the others are ignored. With a match time the time
+ *					of every move is planned from time_left and
+ *					time_increment.
+ *	ABOUT			Reply the engine description.
+ *	END				Exit.
+ *
+ * Extensions used by the Qt client:
+ *
+ *	STOP			Abort the running search, its reply becomes STOPPED.
+ *	JUDGE			Set the position like BOARD without searching, reply
+ *					RESULT r, r is BLACK(1), WHITE(2), DRAW(225) or 0.
+ *
+ * BEGIN, TURN and BOARD get exactly one reply line each, a move, STOPPED or
+ * ERROR. INFO has no reply but may print MESSAGE lines. The search runs on
+ * its own thread so that STOP is read at once, every other command waits for
+ * it to finish.
+ */
+
+#include "tools.h"
+#include "Kernel/macro.h"
+#include "Kernel/thread.h"
+#include "Kernel/uiinc.h"
+#include "Kernel/profile.h"
+
+#include <ctype.h>
+
+#define LINE_SIZE	256
+#define TURN_MARGIN	100		// milliseconds of timeout_turn kept for the reply
+
+extern bool isForbidden;
+
+// moves of the current game, mirrored from the kernel board
+static u8 Hist[15 * 15];
+static int HistNum = 0;
+static int Over = 0;
+
+// rule of the pattern tables and profile file to reload with them
+static bool TableRule;
+static const char* ProfileDir = NULL;
+
+// learned positions file
+static const char* LearnDir = NULL;
+
+// false after INFO timeout_match 0
+static bool MatchClock = true;
+static long MatchLeft = 0;		// last time_left, 0 before the first one
+static long MatchInc = 0;		// time_increment
+
+// search thread
+static thread_t Tid;
+static bool Searching = false;
+
+/*******************************************************************************
+								Board functions
+*******************************************************************************/
+static void game_restart()
+{
+	restart();
+	HistNum = 0;
+	Over = 0;
+}
+
+// play a move of the side to move, return false if illegal
+static bool game_play(const u8 pos)
+{
+	int i;
+
+	if(pos >= 15 * 15 || Over)
+		return false;
+	for(i = 0; i < HistNum; i++)
+		if(Hist[i] == pos)
+			return false;
+
+	player_do_move(pos / 15, pos % 15, &Over, HistNum % 2 ? WHITE : BLACK);
+	Hist[HistNum++] = pos;
+	return true;
+}
+
+static void game_takeback(const int n)
+{
+	undo_move(n);
+	HistNum -= n;
+	Over = 0;
+}
+
+// set the game to a move list, keep the common prefix on the board
+static bool game_set(const u8* moves, const int num)
+{
+	int i, same;
+
+	for(same = 0; same < num && same < HistNum; same++)
+		if(Hist[same] != moves[same])
+			break;
+
+	if(same == 0)
+		game_restart();
+	else
+		game_takeback(HistNum - same);
+
+	for(i = same; i < num; i++)
+	{
+		if(!game_play(moves[i]))
+		{
+			game_restart();
+			return false;
+		}
+	}
+	return true;
+}
+
+/*******************************************************************************
+								Search functions
+*******************************************************************************/
+static void* search_worker(void* arg)
+{
+	int pos, over;
+
+	(void)arg;
+
+	pos = ai_do_move(&over, HistNum % 2 ? WHITE : BLACK);
+	if(pos < 0)
+		printf("STOPPED\n");
+	else
+	{
+		Hist[HistNum++] = pos;
+		Over = over;
+		printf("%d,%d\n", pos % 15, pos / 15);
+	}
+	fflush(stdout);
+	return NULL;
+}
+
+static void search_start()
+{
+	if(Over || HistNum == 15 * 15)
+	{
+		printf("ERROR game is over\n");
+		fflush(stdout);
+		return;
+	}
+
+	Searching = thread_create(&Tid, search_worker, NULL);
+	if(!Searching)
+		search_worker(NULL);
+}
+
+static void search_wait()
+{
+	if(Searching)
+	{
+		thread_join(Tid);
+		Searching = false;
+	}
+}
+
+/*******************************************************************************
+								Command functions
+*******************************************************************************/
+// parse "x,y", return the position or INVALID
+static u8 parse_move(const char* str)
+{
+	int x, y;
+
+	if(sscanf(str, "%d,%d", &x, &y) != 2 || x < 0 || x >= 15 || y < 0 || y >= 15)
+		return INVALID;
+	return y * 15 + x;
+}
+
+// read the lines of BOARD or JUDGE up to DONE
+static int read_board(u8* moves)
+{
+	char line[LINE_SIZE];
+	int num = 0, bad = 0;
+	u8 pos;
+
+	while(fgets(line, LINE_SIZE, stdin) != NULL)
+	{
+		if(!strncmp(line, "DONE", 4))
+			return bad ? -1 : num;
+		pos = parse_move(line);
+		if(pos == INVALID || num == 15 * 15)
+			bad = 1;
+		else
+			moves[num++] = pos;
+	}
+	return -1;
+}
+
+static void set_rule(const bool rule)
+{
+	set_forbidden(rule);
+
+	// pattern tables depend on the rule, rebuild them
+	if(rule != TableRule)
+	{
+		initialize();
+		if(ProfileDir != NULL)
+			profile_load(ProfileDir);
+		TableRule = rule;
+		game_restart();
+	}
+}
+
+// search time of a turn, the reply must arrive within timeout_turn
+static long turn_time(const long timeout)
+{
+	if(timeout > 2 * TURN_MARGIN)
+		return timeout - TURN_MARGIN;
+	return timeout / 2 > 0 ? timeout / 2 : 1;
+}
+
+static void command_info(const char* key, const char* val)
+{
+	long num = atol(val);
+
+	if(!strcmp(key, "rule"))
+		set_rule((atoi(val) & 4) != 0);
+	else if(!strcmp(key, "timeout_turn"))
+		set_time_limit(turn_time(num));
+	else if(!strcmp(key, "timeout_match"))
+	{
+		MatchClock = num > 0;
+		if(!MatchClock)
+			set_match_clock(0, 0);
+	}
+	else if(!strcmp(key, "time_left") && MatchClock)
+	{
+		MatchLeft = num > 0 ? num : 1;
+		set_match_clock(MatchLeft, MatchInc);
+	}
+	else if(!strcmp(key, "time_increment"))
+	{
+		MatchInc = num > 0 ? num : 0;
+		if(MatchClock && MatchLeft > 0)
+			set_match_clock(MatchLeft, MatchInc);
+	}
+	else if(!strcmp(key, "max_memory"))
+		set_memory_limit(num > 0 && num < (1 << 20) ? 1 : num >> 20);
+	else if(!strcmp(key, "profile") && !set_profile(val))
+		printf("MESSAGE unknown profile %s\n", val);
+}
+
+static void usage()
+{
+	printf("usage: sgengine [-p profiles] [-r rule] [-l learned]\n");
+}
+
+int main(int argc, char* argv[])
+{
+	char line[LINE_SIZE], cmd[LINE_SIZE], arg[LINE_SIZE], val[LINE_SIZE];
+	u8 moves[15 * 15];
+	int i, num;
+
+	for(i = 1; i + 1 < argc; i += 2)
+	{
+		if(!strcmp(argv[i], "-p"))
+			ProfileDir = argv[i + 1];
+		else if(!strcmp(argv[i], "-r"))
+			isForbidden = atoi(argv[i + 1]) != 0;
+		else if(!strcmp(argv[i], "-l"))
+			LearnDir = argv[i + 1];
+		else
+			break;
+	}
+	if(i != argc)
+	{
+		usage();
+		return 1;
+	}
+
+	// tables are built before the first command so that START is quick
+	initialize();
+	TableRule = isForbidden;
+	if(ProfileDir != NULL && !profile_load(ProfileDir))
+	{
+		printf("ERROR can't load profiles\n");
+		fflush(stdout);
+	}
+	if(LearnDir != NULL)
+		load_table(LearnDir);
+	game_restart();
+
+	while(fgets(line, LINE_SIZE, stdin) != NULL)
+	{
+		cmd[0] = arg[0] = val[0] = '\0';
+		if(sscanf(line, "%s %s %s", cmd, arg, val) < 1)
+			continue;
+		for(i = 0; cmd[i]; i++)
+			cmd[i] = toupper((unsigned char)cmd[i]);
+
+		if(!strcmp(cmd, "STOP"))
+		{
+			if(Searching)
+			{
+				abort_search(1);
+				search_wait();
+				abort_search(0);
+			}
+			continue;
+		}
+
+		search_wait();
+
+		if(!strcmp(cmd, "START"))
+		{
+			if(atoi(arg) == 15)
+			{
+				game_restart();
+				printf("OK\n");
+			}
+			else
+				printf("ERROR only 15 * 15 board is supported\n");
+		}
+		else if(!strcmp(cmd, "RESTART"))
+		{
+			game_restart();
+			printf("OK\n");
+		}
+		else if(!strcmp(cmd, "BEGIN"))
+		{
+			game_restart();
+			search_start();
+		}
+		else if(!strcmp(cmd, "TURN"))
+		{
+			if(game_play(parse_move(arg)))
+				search_start();
+			else
+				printf("ERROR illegal move %s\n", arg);
+		}
+		else if(!strcmp(cmd, "BOARD") || !strcmp(cmd, "JUDGE"))
+		{
+			num = read_board(moves);
+			if(num < 0 || !game_set(moves, num))
+				printf("ERROR illegal board\n");
+			else if(cmd[0] == 'J')
+				printf("RESULT %d\n", Over);
+			else
+				search_start();
+		}
+		else if(!strcmp(cmd, "TAKEBACK"))
+		{
+			if(HistNum > 0 && Hist[HistNum - 1] == parse_move(arg))
+			{
+				game_takeback(1);
+				printf("OK\n");
+			}
+			else
+				printf("ERROR can't take back %s\n", arg);
+		}
+		else if(!strcmp(cmd, "INFO"))
+			command_info(arg, val);
+		else if(!strcmp(cmd, "ABOUT"))
+			printf("name=\"SunGomoku\", version=\"1.1.3\", country=\"China\"\n");
+		else if(!strcmp(cmd, "END"))
+			break;
+		else
+			printf("UNKNOWN %s\n", cmd);
+		fflush(stdout);
+	}
+
+	search_wait();
+	if(LearnDir != NULL && !save_table(LearnDir))
+		fprintf(stderr, "can't save learned positions\n");
+	uninitialize();
+	return 0;
+}
+
@@ -0,0 +1,13 @@
+#-------------------------------------------------
+#
+# Headless engine for the Gomocup protocol and the Qt client
+#
+#-------------------------------------------------
+
+TARGET = sgengine
+TEMPLATE = app
+
+include(kernel.pri)
+
+SOURCES += \
+    engine.c
@@ -0,0 +1,45 @@
+# Engine sources shared by the command line tools
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    $$PWD/../Kernel/board.c \
+    $$PWD/../Kernel/book.c \
+    $$PWD/../Kernel/hash.c \
+    $$PWD/../Kernel/mapfile.c \
+    $$PWD/../Kernel/profile.c \
+    $$PWD/../Kernel/progress.c \
+    $$PWD/../Kernel/renju.c \
+    $$PWD/../Kernel/search.c \
+    $$PWD/../Kernel/thread.c \
+    $$PWD/../Kernel/timeman.c \
+    $$PWD/../Kernel/tree.c \
+    $$PWD/../Kernel/ttable.c \
+    $$PWD/../Kernel/uiinc.c \
+    $$PWD/tools.c
+
+HEADERS += \
+    $$PWD/../Kernel/board.h \
+    $$PWD/../Kernel/book.h \
+    $$PWD/../Kernel/hash.h \
+    $$PWD/../Kernel/macro.h \
+    $$PWD/../Kernel/mapfile.h \
+    $$PWD/../Kernel/mvlist.h \
+    $$PWD/../Kernel/pattern.h \
+    $$PWD/../Kernel/profile.h \
+    $$PWD/../Kernel/progress.h \
+    $$PWD/../Kernel/renju.h \
+    $$PWD/../Kernel/search.h \
+    $$PWD/../Kernel/thread.h \
+    $$PWD/../Kernel/timeman.h \
+    $$PWD/../Kernel/tree.h \
+    $$PWD/../Kernel/ttable.h \
+    $$PWD/../Kernel/uiinc.h \
+    $$PWD/tools.h
+
+CONFIG += console
+CONFIG -= app_bundle qt
+
+LIBS += -lpthread -lm
+
+QMAKE_CFLAGS_RELEASE += -O3       # Release -O3
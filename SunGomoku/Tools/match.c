@@ -0,0 +1,350 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * match.c - self-play match between two engine configurations
+ *
+ * Usage: sgmatch [-p profiles] [-a config] [-b config] [-n games] [-t threads]
+ *				  [-r rule] [-c match,inc] [-s elo0,elo1] [-o file]
+ *
+ *	-p		Load engine profiles from this file.
+ *	-a, -b	Configurations of engine A and B, e.g. "normal,leaf=12,book=0".
+ *			Both start from the hard profile.
+ *	-n		Number of games, two per opening with colors swapped.
+ *	-t		Number of concurrent games. Default is the number of cores.
+ *	-r		1 to consider forbidden points, 0 to neglect them.
+ *	-c		Play on a match clock of each engine, match time and increment
+ *			per move in milliseconds. A side whose clock runs out loses.
+ *	-s		Stop early when SPRT accepts elo0 or elo1 (alpha = beta = 0.05).
+ *	-o		Append all games to this file, see game_write().
+ */
+
+#include <pthread.h>
+#include <math.h>
+
+#include "tools.h"
+#include "Kernel/macro.h"
+#include "Kernel/thread.h"
+#include "Kernel/board.h"
+#include "Kernel/search.h"
+#include "Kernel/uiinc.h"
+#include "Kernel/profile.h"
+
+#define SPRT_ALPHA	0.05
+#define SPRT_BETA	0.05
+
+extern bool isForbidden;
+
+// match settings
+static search_t Eng[2];
+static u8 Suite[SUITE_NUM][3];
+static int SuiteNum;
+static int Total = 2 * SUITE_NUM;
+static bool Sprt = false;
+static double Elo0, Elo1;
+static bool Clock = false;
+static u32 ClockMatch, ClockInc;		// milliseconds
+static FILE* Fout = NULL;
+
+// match state shared by workers
+static pthread_mutex_t Lock = PTHREAD_MUTEX_INITIALIZER;
+static int Next = 0;
+static int Played = 0;
+static int Win = 0, Draw = 0, Lose = 0;		// from engine A's view
+static bool Stop = false;
+static int TimeLoss = 0;
+static double Longest = 0.0;		// seconds of the longest move on the clock
+
+/*******************************************************************************
+								Statistic functions
+*******************************************************************************/
+// elo difference of a score rate
+static double elo_diff(double p)
+{
+	if(p <= 0.0)
+		p = 1e-6;
+	if(p >= 1.0)
+		p = 1.0 - 1e-6;
+	return -400.0 * log10(1.0 / p - 1.0);
+}
+
+// score rate of an elo difference
+static double elo_rate(double elo)
+{
+	return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+// mean and variance of a single game score
+static void score_stat(const double w, const double d, const double l,
+						double* mu, double* var)
+{
+	double n = w + d + l;
+
+	*mu = (w + d * 0.5) / n;
+	*var = (w * (1.0 - *mu) * (1.0 - *mu) + d * (0.5 - *mu) * (0.5 - *mu)
+			+ l * *mu * *mu) / n;
+}
+
+// elo difference and its 95% error bar
+static void elo_stat(double* elo, double* err)
+{
+	double mu, var, dev;
+
+	score_stat(Win, Draw, Lose, &mu, &var);
+	dev = 1.95996 * sqrt(var / (Win + Draw + Lose));
+
+	*elo = elo_diff(mu);
+	*err = (elo_diff(mu + dev) - elo_diff(mu - dev)) / 2.0;
+}
+
+// log likelihood ratio of elo1 against elo0
+// half a game is added to each result so that early one-sided runs stay finite
+static double sprt_llr()
+{
+	double mu, var;
+	double s0 = elo_rate(Elo0), s1 = elo_rate(Elo1);
+
+	score_stat(Win + 0.5, Draw + 0.5, Lose + 0.5, &mu, &var);
+
+	return (s1 - s0) * (2.0 * mu - s0 - s1) * (Win + Draw + Lose) / (2.0 * var);
+}
+
+/*******************************************************************************
+								Match functions
+*******************************************************************************/
+/*
+ * Play one game from an opening of the suite.
+ *
+ * @param [in]	bd		Board owned by the calling thread.
+ * @param [in]	index	Game index. Opening is index / 2, black is index % 2.
+ * @param [out]	game	The game record.
+ */
+static void play_game(board_t* bd, const int index, game_t* game)
+{
+	search_t srh;
+	u8 pos, color, over = false;
+	u32 left[2] = { ClockMatch, ClockMatch };
+	double start, used;
+	int i, e;
+
+	game->opening = (index / 2) % SuiteNum;
+	game->black = index % 2;
+	game->rule = isForbidden;
+	game->num = 0;
+
+	board_reset(bd);
+
+	// opening stones
+	for(i = 0; i < 3; i++)
+	{
+		pos = Suite[game->opening][i];
+		do_move(bd, pos, i % 2 ? WHITE : BLACK);
+		game->moves[game->num++] = pos;
+	}
+
+	color = WHITE;
+	while(!over)
+	{
+		// engine 0 plays black when game->black is 0
+		e = (color == BLACK) == (game->black == 1);
+		srh = Eng[e];
+		srh.me = color;
+		srh.opp = BLACK + WHITE - color;
+		srh.left = left[e];
+		srh.inc = ClockInc;
+
+		start = wall_time();
+		pos = heuristic(bd, &srh);
+		used = wall_time() - start;
+
+		// a move beyond the clock loses
+		if(Clock)
+		{
+			pthread_mutex_lock(&Lock);
+			if(used > Longest)
+				Longest = used;
+			if(used * 1000 >= left[e])
+				TimeLoss++;
+			pthread_mutex_unlock(&Lock);
+
+			if(used * 1000 >= left[e])
+			{
+				over = srh.opp;
+				break;
+			}
+			left[e] = left[e] - (u32)(used * 1000) + ClockInc;
+		}
+
+		// an illegal move loses
+		if(pos >= 15 * 15 || bd->arr[pos] != EMPTY)
+		{
+			over = srh.opp;
+			break;
+		}
+
+		do_move(bd, pos, color);
+		game->moves[game->num++] = pos;
+		over = board_gameover(bd);
+		color = srh.opp;
+	}
+	game->result = over;
+}
+
+static void* match_worker(void* arg)
+{
+	board_t* bd = (board_t*)malloc(sizeof(board_t));
+	game_t game;
+	double elo, err;
+	int index;
+
+	(void)arg;
+
+	while(1)
+	{
+		pthread_mutex_lock(&Lock);
+		if(Stop || Next >= Total)
+		{
+			pthread_mutex_unlock(&Lock);
+			break;
+		}
+		index = Next++;
+		pthread_mutex_unlock(&Lock);
+
+		play_game(bd, index, &game);
+
+		pthread_mutex_lock(&Lock);
+		Played++;
+		if(game.result == DRAW)
+			Draw++;
+		else if((game.result == BLACK) == (game.black == 0))
+			Win++;
+		else
+			Lose++;
+
+		if(Fout != NULL && !game_write(Fout, &game))
+			printf("failed to write game!\n");
+
+		elo_stat(&elo, &err);
+		printf("game %d/%d  opening %d  %s  +%d =%d -%d  elo %.1f +- %.1f",
+				Played, Total, game.opening, game.black ? "B-A" : "A-B",
+				Win, Draw, Lose, elo, err);
+		if(Sprt)
+		{
+			printf("  llr %.2f", sprt_llr());
+			if(sprt_llr() >= log((1.0 - SPRT_BETA) / SPRT_ALPHA)
+			|| sprt_llr() <= log(SPRT_BETA / (1.0 - SPRT_ALPHA)))
+				Stop = true;
+		}
+		putchar('\n');
+		fflush(stdout);
+		pthread_mutex_unlock(&Lock);
+	}
+
+	free(bd);
+	return NULL;
+}
+
+static void usage()
+{
+	printf("usage: sgmatch [-p profiles] [-a config] [-b config] [-n games]"
+			" [-t threads] [-r rule] [-c match,inc] [-s elo0,elo1] [-o file]\n");
+}
+
+int main(int argc, char* argv[])
+{
+	pthread_t* tid;
+	char* conf[2] = { "", "" };
+	int threads = cpu_count();
+	double elo, err, llr;
+	int i;
+
+	for(i = 1; i + 1 < argc; i += 2)
+	{
+		if(!strcmp(argv[i], "-p"))
+		{
+			if(!profile_load(argv[i + 1]))
+			{
+				printf("can't load profiles!\n");
+				return 1;
+			}
+		}
+		else if(!strcmp(argv[i], "-a"))
+			conf[0] = argv[i + 1];
+		else if(!strcmp(argv[i], "-b"))
+			conf[1] = argv[i + 1];
+		else if(!strcmp(argv[i], "-n"))
+			Total = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-t"))
+			threads = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-r"))
+			isForbidden = atoi(argv[i + 1]) != 0;
+		else if(!strcmp(argv[i], "-c")
+		&& sscanf(argv[i + 1], "%u,%u", &ClockMatch, &ClockInc) == 2 && ClockMatch > 0)
+			Clock = true;
+		else if(!strcmp(argv[i], "-s") && sscanf(argv[i + 1], "%lf,%lf", &Elo0, &Elo1) == 2)
+			Sprt = true;
+		else if(!strcmp(argv[i], "-o"))
+		{
+			if((Fout = fopen(argv[i + 1], "ab")) == NULL)
+			{
+				printf("can't open game file!\n");
+				return 1;
+			}
+		}
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	Eng[0] = profile_find("hard")->srh;
+	Eng[1] = profile_find("hard")->srh;
+
+	if(i != argc || Total <= 0 || threads <= 0
+	|| !config_parse(&Eng[0], conf[0]) || !config_parse(&Eng[1], conf[1]))
+	{
+		usage();
+		return 1;
+	}
+
+	// pattern tables depend on isForbidden so it is set before
+	initialize();
+	SuiteNum = opening_suite(Suite);
+
+	tid = (pthread_t*)malloc(threads * sizeof(pthread_t));
+	for(i = 0; i < threads; i++)
+		pthread_create(&tid[i], NULL, match_worker, NULL);
+	for(i = 0; i < threads; i++)
+		pthread_join(tid[i], NULL);
+	free(tid);
+
+	if(Played)
+	{
+		elo_stat(&elo, &err);
+		printf("\nA vs B: +%d =%d -%d in %d games, elo %.1f +- %.1f\n",
+				Win, Draw, Lose, Played, elo, err);
+		if(Clock)
+			printf("clock: %d losses on time, longest move %.3f s\n", TimeLoss, Longest);
+		if(Sprt)
+		{
+			llr = sprt_llr();
+			if(llr >= log((1.0 - SPRT_BETA) / SPRT_ALPHA))
+				printf("SPRT: H1 accepted, llr %.2f\n", llr);
+			else if(llr <= log(SPRT_BETA / (1.0 - SPRT_ALPHA)))
+				printf("SPRT: H0 accepted, llr %.2f\n", llr);
+			else
+				printf("SPRT: inconclusive, llr %.2f\n", llr);
+		}
+	}
+
+	if(Fout != NULL)
+		fclose(Fout);
+	uninitialize();
+
+	return 0;
+}
+
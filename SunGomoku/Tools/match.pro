@@ -0,0 +1,13 @@
+#-------------------------------------------------
+#
+# Self-play match between two engine configurations
+#
+#-------------------------------------------------
+
+TARGET = sgmatch
+TEMPLATE = app
+
+include(kernel.pri)
+
+SOURCES += \
+    match.c
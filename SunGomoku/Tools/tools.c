@@ -0,0 +1,101 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * tools.c - helper functions shared by the command line tools
+ */
+
+#include "tools.h"
+#include "Kernel/macro.h"
+#include "Kernel/search.h"
+#include "Kernel/profile.h"
+
+int opening_suite(u8 (*suite)[3])
+{
+	int r, c, cnt = 0;
+
+	// direct openings, white on H9, mirrored by the center column
+	for(r = 5; r <= 9; r++)
+	{
+		for(c = 5; c <= 7; c++)
+		{
+			if(r * 15 + c == 112 || r * 15 + c == 97)
+				continue;
+			suite[cnt][0] = 112;
+			suite[cnt][1] = 97;
+			suite[cnt++][2] = r * 15 + c;
+		}
+	}
+
+	// indirect openings, white on I9, mirrored by the diagonal through it
+	for(r = 5; r <= 9; r++)
+	{
+		for(c = 5; c <= 9; c++)
+		{
+			if(r * 15 + c == 112 || r * 15 + c == 98 || (r - 7) + (c - 7) > 0)
+				continue;
+			suite[cnt][0] = 112;
+			suite[cnt][1] = 98;
+			suite[cnt++][2] = r * 15 + c;
+		}
+	}
+
+	return cnt;
+}
+
+bool config_parse(search_t* srh, const char* str)
+{
+	char buf[256], *item, *eq;
+	const profile_t* pro;
+
+	strncpy(buf, str, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = '\0';
+
+	for(item = strtok(buf, ","); item != NULL; item = strtok(NULL, ","))
+	{
+		if((eq = strchr(item, '=')) == NULL)
+		{
+			if((pro = profile_find(item)) == NULL)
+				return false;
+			*srh = pro->srh;
+			continue;
+		}
+		*eq = '\0';
+		if(!profile_set(srh, item, strtol(eq + 1, NULL, 10)))
+			return false;
+	}
+	return true;
+}
+
+bool game_write(FILE* fout, const game_t* game)
+{
+	u8 head[5] = { game->opening, game->black, game->rule, game->result, game->num };
+
+	if(fwrite(head, 1, 5, fout) != 5)
+		return false;
+	if(fwrite(game->moves, 1, game->num, fout) != game->num)
+		return false;
+	return true;
+}
+
+bool game_read(FILE* fin, game_t* game)
+{
+	u8 head[5];
+
+	if(fread(head, 1, 5, fin) != 5)
+		return false;
+
+	game->opening = head[0];
+	game->black = head[1];
+	game->rule = head[2];
+	game->result = head[3];
+	game->num = head[4];
+
+	if(fread(game->moves, 1, game->num, fin) != game->num)
+		return false;
+	return true;
+}
+
@@ -0,0 +1,70 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * tools.h - helper functions shared by the command line tools
+ */
+
+#ifndef __TOOLS_H__
+#define __TOOLS_H__
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include "Kernel/macro.h"
+#include "Kernel/search.h"
+
+#define SUITE_NUM	26		// # of three-stone openings in the suite
+
+// game record structure
+typedef struct {
+	u8 opening;					// opening index in the suite
+	u8 black;					// engine playing black, 0 or 1
+	u8 rule;					// 1 if forbidden points are considered
+	u8 result;					// BLACK, WHITE or DRAW
+	u8 num;						// # of moves
+	u8 moves[15 * 15];			// move sequence including the opening
+} game_t;
+
+/*
+ * Generate the balanced opening suite.
+ * Black H8 with white on a direct or an indirect neighbor, plus every third
+ * black stone within two lines of H8 that is unique under symmetry.
+ *
+ * @param [out]	suite	Three moves per opening.
+ *
+ * @return	The number of openings, SUITE_NUM.
+ */
+int opening_suite(u8 (*suite)[3]);
+
+/*
+ * Change search_t members according to a string like "normal,dep=6,leaf=12".
+ * A name copies the whole profile, a key=value pair sets one member by its
+ * profile key. Items are applied from left to right.
+ *
+ * Return false if the string contains an unknown profile or key.
+ */
+bool config_parse(search_t* srh, const char* str);
+
+/*
+ * Append a game record to a file. Return false if fails.
+ *
+ * Record layout: opening, black, rule, result, num, moves[num], one byte each.
+ */
+bool game_write(FILE* fout, const game_t* game);
+
+/*
+ * Read the next game record from a file. Return false at the end of file.
+ */
+bool game_read(FILE* fin, game_t* game);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,388 @@
+/*                     _______
+ *  Gomoku Engine     / _____/
+ *                   / /______  ________
+ *  developed by    /____  / / / / __  /
+ *                 _____/ / /_/ / / / /
+ *  2019.1        /______/_____/_/ /_/
+ *
+ * tune.c - fit score_t weights to self-play results (Texel method)
+ *
+ * Usage: sgtune [-r rule] [-i iterations] [-l rate] [-t threads] file...
+ *
+ *	-r		1 to consider forbidden points, 0 to neglect them. Games played
+ *			under the other rule are skipped.
+ *	-i		Number of gradient descent iterations.
+ *	-l		Learning rate in score units.
+ *	-t		Number of threads. Default is the number of cores.
+ *	file	Game files written by sgmatch -o.
+ *
+ * Every quiet position (no four and no free three on board) is labeled with
+ * the game result. The win rate is predicted by sigmoid(K * evaluate()) and
+ * the weights are fitted by minimizing the mean squared error, K is fitted
+ * first with the current weights so that the new weights keep their scale.
+ */
+
+#include <pthread.h>
+#include <math.h>
+
+#include "tools.h"
+#include "Kernel/macro.h"
+#include "Kernel/thread.h"
+#include "Kernel/pattern.h"
+#include "Kernel/board.h"
+#include "Kernel/search.h"
+#include "Kernel/uiinc.h"
+
+#define FEAT_NUM	11			// # of weighted patterns
+#define CHUNK		4096		// # of positions per inner loop
+
+extern bool isForbidden;
+extern search_t Srh;
+
+// weighted pattern types, same order as in score_t
+static const u8 feat_type[FEAT_NUM] = {
+	FREE4, DEAD4, FREE3, DEAD3, FREE2, DEAD2, FREE1, DEAD1, FREE3a, FREE2a, FREE1a
+};
+
+static const char* feat_name[FEAT_NUM] = {
+	"free4", "dead4", "free3", "dead3", "free2", "dead2",
+	"free1", "dead1", "free3a", "free2a", "free1a"
+};
+
+// position set in structure of arrays layout
+static float* Feat[FEAT_NUM];		// black count - white count
+static float* Res;					// 1 black wins, 0.5 draw, 0 white wins
+static int Num = 0;
+static int Cap = 0;
+
+// fitting state
+static double W[FEAT_NUM];
+static double K;
+static int Threads;
+
+/*******************************************************************************
+							Position extraction functions
+*******************************************************************************/
+static void pos_push(const board_t* bd, const float res)
+{
+	int i;
+
+	if(Num == Cap)
+	{
+		Cap = Cap ? Cap * 2 : 1 << 16;
+		for(i = 0; i < FEAT_NUM; i++)
+			Feat[i] = (float*)realloc(Feat[i], Cap * sizeof(float));
+		Res = (float*)realloc(Res, Cap * sizeof(float));
+	}
+
+	for(i = 0; i < FEAT_NUM; i++)
+		Feat[i][Num] = pattern_read(pat(bd), feat_type[i], BLACK)
+					 - pattern_read(pat(bd), feat_type[i], WHITE);
+	Res[Num++] = res;
+}
+
+// return true if there is no four and no free three on board
+static bool pos_isquiet(const board_t* bd)
+{
+	u8 color;
+
+	if(board_gameover(bd))
+		return false;
+
+	for(color = BLACK; color <= WHITE; color++)
+	{
+		if(pattern_read(pat(bd), FREE4, color) || pattern_read(pat(bd), DEAD4, color)
+		|| pattern_read(pat(bd), FREE3, color) || pattern_read(pat(bd), FREE3a, color))
+			return false;
+	}
+	return true;
+}
+
+// replay all games of a file and collect quiet positions
+static bool pos_load(board_t* bd, const char* dir)
+{
+	FILE* fin;
+	game_t game;
+	float res;
+	int i;
+
+	if((fin = fopen(dir, "rb")) == NULL)
+	{
+		printf("can't open game file %s!\n", dir);
+		return false;
+	}
+
+	while(game_read(fin, &game))
+	{
+		if(game.rule != isForbidden)
+			continue;
+
+		if(game.result == BLACK)
+			res = 1.0f;
+		else if(game.result == WHITE)
+			res = 0.0f;
+		else
+			res = 0.5f;
+
+		board_reset(bd);
+		for(i = 0; i < game.num; i++)
+		{
+			do_move(bd, game.moves[i], i % 2 ? WHITE : BLACK);
+			if(i >= 3 && pos_isquiet(bd))
+				pos_push(bd, res);
+		}
+	}
+
+	fclose(fin);
+	return true;
+}
+
+/*******************************************************************************
+								Fitting functions
+*******************************************************************************/
+// per-thread job
+typedef struct {
+	int begin;					// first position
+	int end;					// one past the last position
+	double err;					// [out] sum of squared errors
+	double grad[FEAT_NUM];		// [out] sum of error gradients
+} job_t;
+
+static void* fit_worker(void* arg)
+{
+	job_t* job = (job_t*)arg;
+	float w[FEAT_NUM], e[CHUNK], d[CHUNK];
+	double err = 0.0, grad[FEAT_NUM] = { 0.0 };
+	float k = K;
+	int i, j, n, b;
+
+	for(j = 0; j < FEAT_NUM; j++)
+		w[j] = W[j];
+
+	for(b = job->begin; b < job->end; b += CHUNK)
+	{
+		n = job->end - b < CHUNK ? job->end - b : CHUNK;
+
+		// evaluate, one pattern at a time so that the loops vectorize
+		for(i = 0; i < n; i++)
+			e[i] = 0.0f;
+		for(j = 0; j < FEAT_NUM; j++)
+		{
+			const float* x = Feat[j] + b;
+			for(i = 0; i < n; i++)
+				e[i] += w[j] * x[i];
+		}
+
+		// sigmoid, error and its derivative on the evaluation
+		for(i = 0; i < n; i++)
+		{
+			float s = 1.0f / (1.0f + expf(-k * e[i]));
+			float r = Res[b + i] - s;
+			err += r * r;
+			d[i] = -2.0f * r * s * (1.0f - s) * k;
+		}
+
+		for(j = 0; j < FEAT_NUM; j++)
+		{
+			const float* x = Feat[j] + b;
+			float g = 0.0f;
+			for(i = 0; i < n; i++)
+				g += d[i] * x[i];
+			grad[j] += g;
+		}
+	}
+
+	job->err = err;
+	for(j = 0; j < FEAT_NUM; j++)
+		job->grad[j] = grad[j];
+	return NULL;
+}
+
+/*
+ * Return the mean squared error of the current weights.
+ * Mean gradient is written to grad if it is not NULL.
+ */
+static double fit_error(double* grad)
+{
+	pthread_t tid[64];
+	job_t job[64];
+	double err = 0.0;
+	int i, j, step = (Num + Threads - 1) / Threads;
+
+	for(i = 0; i < Threads; i++)
+	{
+		job[i].begin = i * step < Num ? i * step : Num;
+		job[i].end = (i + 1) * step < Num ? (i + 1) * step : Num;
+		pthread_create(&tid[i], NULL, fit_worker, &job[i]);
+	}
+
+	if(grad != NULL)
+		for(j = 0; j < FEAT_NUM; j++)
+			grad[j] = 0.0;
+
+	for(i = 0; i < Threads; i++)
+	{
+		pthread_join(tid[i], NULL);
+		err += job[i].err;
+		if(grad != NULL)
+			for(j = 0; j < FEAT_NUM; j++)
+				grad[j] += job[i].grad[j] / Num;
+	}
+
+	return err / Num;
+}
+
+// golden section search of K with the current weights
+static void fit_k()
+{
+	double a = 1e-6, b = 1e-1;
+	double g = (sqrt(5.0) - 1.0) / 2.0;
+	double c, d, fc, fd;
+	int i;
+
+	// search on log scale
+	a = log(a);
+	b = log(b);
+	c = b - g * (b - a);
+	d = a + g * (b - a);
+	K = exp(c);
+	fc = fit_error(NULL);
+	K = exp(d);
+	fd = fit_error(NULL);
+
+	for(i = 0; i < 40; i++)
+	{
+		if(fc < fd)
+		{
+			b = d;
+			d = c;
+			fd = fc;
+			c = b - g * (b - a);
+			K = exp(c);
+			fc = fit_error(NULL);
+		}
+		else
+		{
+			a = c;
+			c = d;
+			fc = fd;
+			d = a + g * (b - a);
+			K = exp(d);
+			fd = fit_error(NULL);
+		}
+	}
+	K = exp((a + b) / 2.0);
+}
+
+// Adam optimizer on the weights with K fixed
+static void fit_weights(const int iter, const double rate)
+{
+	double grad[FEAT_NUM], m[FEAT_NUM] = { 0.0 }, v[FEAT_NUM] = { 0.0 };
+	double b1 = 0.9, b2 = 0.999, p1 = 1.0, p2 = 1.0, err;
+	int i, j;
+
+	for(i = 1; i <= iter; i++)
+	{
+		err = fit_error(grad);
+		p1 *= b1;
+		p2 *= b2;
+
+		for(j = 0; j < FEAT_NUM; j++)
+		{
+			m[j] = b1 * m[j] + (1.0 - b1) * grad[j];
+			v[j] = b2 * v[j] + (1.0 - b2) * grad[j] * grad[j];
+			W[j] -= rate * (m[j] / (1.0 - p1)) / (sqrt(v[j] / (1.0 - p2)) + 1e-12);
+		}
+
+		if(i % 100 == 0 || i == iter)
+		{
+			printf("iteration %d  error %.6f\n", i, err);
+			fflush(stdout);
+		}
+	}
+}
+
+static void weights_from_score(const score_t* sc)
+{
+	long w[FEAT_NUM] = {
+		sc->free4, sc->dead4, sc->free3, sc->dead3, sc->free2, sc->dead2,
+		sc->free1, sc->dead1, sc->free3a, sc->free2a, sc->free1a
+	};
+	int j;
+
+	for(j = 0; j < FEAT_NUM; j++)
+		W[j] = w[j];
+}
+
+static void usage()
+{
+	printf("usage: sgtune [-r rule] [-i iterations] [-l rate] [-t threads] file...\n");
+}
+
+int main(int argc, char* argv[])
+{
+	board_t* bd;
+	int iter = 1000;
+	double rate = 4.0;
+	int i, j;
+
+	Threads = cpu_count();
+
+	for(i = 1; i + 1 < argc && argv[i][0] == '-'; i += 2)
+	{
+		if(!strcmp(argv[i], "-r"))
+			isForbidden = atoi(argv[i + 1]) != 0;
+		else if(!strcmp(argv[i], "-i"))
+			iter = atoi(argv[i + 1]);
+		else if(!strcmp(argv[i], "-l"))
+			rate = atof(argv[i + 1]);
+		else if(!strcmp(argv[i], "-t"))
+			Threads = atoi(argv[i + 1]);
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+	if(i >= argc || iter <= 0 || Threads <= 0)
+	{
+		usage();
+		return 1;
+	}
+	if(Threads > 64)
+		Threads = 64;
+
+	// pattern tables depend on isForbidden so it is set before
+	initialize();
+
+	bd = (board_t*)malloc(sizeof(board_t));
+	for(; i < argc; i++)
+		if(!pos_load(bd, argv[i]))
+			return 1;
+	free(bd);
+
+	if(Num == 0)
+	{
+		printf("no quiet position found!\n");
+		return 1;
+	}
+	printf("%d quiet positions\n", Num);
+
+	weights_from_score(&Srh.sc);
+	fit_k();
+	printf("K %g  error %.6f\n", K, fit_error(NULL));
+
+	fit_weights(iter, rate);
+
+	// result as score_t initializer and as sgmatch configuration
+	printf("\n");
+	for(j = 0; j < FEAT_NUM; j++)
+		printf("\t\t.%s = %ld,\n", feat_name[j], lround(W[j]));
+	printf("\n");
+	for(j = 0; j < FEAT_NUM; j++)
+		printf("%s=%ld%s", feat_name[j], lround(W[j]), j + 1 < FEAT_NUM ? "," : "\n");
+
+	uninitialize();
+	return 0;
+}
+
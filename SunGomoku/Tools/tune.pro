@@ -0,0 +1,13 @@
+#-------------------------------------------------
+#
+# Texel tuning of score_t weights over self-play games
+#
+#-------------------------------------------------
+
+TARGET = sgtune
+TEMPLATE = app
+
+include(kernel.pri)
+
+SOURCES += \
+    tune.c
@@ -1,10 +1,15 @@
 #include "xrUI/xrhall.h"
+#include "xrUI/xrengine.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
+    // --engine runs the search in sgengine next to the executable
+    if(a.arguments().contains("--engine"))
+        xrEngine::enable(QCoreApplication::applicationDirPath() + "/sgengine");
+
     xrHall hall;
     hall.show();
 
@@ -4,6 +4,7 @@
 chessboard::chessboard(){
     memset(chess,0,sizeof(chess));
     player=0;
+    stamp=0;
 }
 
 bool chessboard::judge(int x,int y){
@@ -15,12 +16,14 @@ bool chessboard::judge(int x,int y){
 
 void chessboard::go(int x,int y){
     player++;
+    stamp++;
     chess[x][y]=2-player%2;
     chessPoint.push_back(QPoint(x,y));
 }
 
 int chessboard::undo(int j){
     int x,y;
+    stamp++;
     for(int i=0;i<j;i++)
     {
         x=chessPoint.last().x();
@@ -35,4 +38,14 @@ int chessboard::undo(int j){
 void chessboard::cleanup(){
     memset(chess,0,sizeof(chess));
     player=0;
+    stamp++;
+    chessPoint.clear();
+}
+
+// positions 15*x+y in playing order
+QVector<int> chessboard::moves() const{
+    QVector<int> pos;
+    for(int i=0;i<chessPoint.size();i++)
+        pos.push_back(15*chessPoint[i].x()+chessPoint[i].y());
+    return pos;
 }
@@ -15,10 +15,12 @@ public:
     chessboard();
     int chess[15][15];
     int player;
+    int stamp;          // changes with every go, undo and cleanup
     bool judge(int x,int y);
     void go(int x,int y);
     int undo(int j);
     void cleanup();
+    QVector<int> moves() const;
 
 private:
     QVector<QPoint> chessPoint;
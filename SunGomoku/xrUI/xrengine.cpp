@@ -0,0 +1,205 @@
+#include "xrengine.h"
+
+#include <QCoreApplication>
+
+xrEngine *xrEngine::instance = nullptr;
+
+xrEngine *xrEngine::shared()
+{
+    return instance;
+}
+
+void xrEngine::enable(const QString &program)
+{
+    if(instance == nullptr)
+        instance = new xrEngine(program, QCoreApplication::instance());
+}
+
+xrEngine::xrEngine(const QString &program, QObject *parent) :
+    QObject(parent), program(program)
+{
+    started = false;
+    waiting = false;
+
+    process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    connect(&process, SIGNAL(readyReadStandardOutput()), this, SLOT(readReply()));
+    connect(&process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(processDied()));
+    connect(&process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(processDied()));
+
+    launch();
+}
+
+xrEngine::~xrEngine()
+{
+    process.disconnect(this);
+    if(process.state() != QProcess::NotRunning)
+    {
+        process.write("STOP\nEND\n");
+        if(!process.waitForFinished(1000))
+            process.kill();
+    }
+}
+
+bool xrEngine::isReady() const
+{
+    return started;
+}
+
+void xrEngine::launch()
+{
+    started = false;
+    waiting = false;
+    process.start(program, QStringList());
+    process.write("START 15\n");
+}
+
+void xrEngine::judge(const QVector<int> &moves, QObject *owner)
+{
+    Request req;
+    req.owner = owner;
+    req.isJudge = true;
+    req.cancelled = false;
+    req.pos = -1;
+    req.text = boardText("JUDGE", moves);
+    post(req);
+}
+
+void xrEngine::think(const QVector<int> &moves, const QString &profile, bool forbidden, QObject *owner)
+{
+    // the process is shared, so every request carries its settings
+    Request req;
+    req.owner = owner;
+    req.isJudge = false;
+    req.cancelled = false;
+    req.pos = -1;
+    req.moves = moves;
+    req.text = "INFO rule " + QByteArray::number(forbidden ? 4 : 1) + "\n";
+    if(!profile.isEmpty())
+        req.text += "INFO profile " + profile.toUtf8() + "\n";
+    req.text += boardText("BOARD", moves);
+    post(req);
+}
+
+void xrEngine::stop(QObject *owner)
+{
+    // drop the requests not sent yet
+    for(int i = requests.size() - 1; i >= (waiting ? 1 : 0); i--)
+        if(requests[i].owner == owner)
+            requests.removeAt(i);
+
+    // the sent one still gets its reply, which is discarded
+    if(waiting && requests.head().owner == owner && !requests.head().cancelled)
+    {
+        requests.head().cancelled = true;
+        if(!requests.head().isJudge)
+            process.write("STOP\n");
+    }
+}
+
+void xrEngine::post(const Request &req)
+{
+    if(process.state() == QProcess::NotRunning)
+        launch();
+    requests.enqueue(req);
+    sendNext();
+}
+
+void xrEngine::sendNext()
+{
+    if(!started || waiting || requests.isEmpty())
+        return;
+    waiting = true;
+    process.write(requests.head().text);
+}
+
+QByteArray xrEngine::boardText(const char *cmd, const QVector<int> &moves)
+{
+    QByteArray text(cmd);
+    text += "\n";
+    for(int i = 0; i < moves.size(); i++)
+        text += QByteArray::number(moves[i]%15) + "," + QByteArray::number(moves[i]/15)
+                + "," + (i%2 == moves.size()%2 ? "1" : "2") + "\n";
+    text += "DONE\n";
+    return text;
+}
+
+void xrEngine::readReply()
+{
+    while(process.canReadLine())
+    {
+        QByteArray line = process.readLine().trimmed();
+
+        if(line.isEmpty() || line.startsWith("MESSAGE") || line.startsWith("DEBUG"))
+            continue;
+
+        if(!started)
+        {
+            // reply of START, errors before it are about the profiles
+            if(line == "OK")
+            {
+                started = true;
+                emit ready();
+                sendNext();
+            }
+            continue;
+        }
+
+        if(!waiting)
+            continue;
+
+        Request req = requests.dequeue();
+        waiting = false;
+        if(!req.cancelled)
+            reply(req, line);
+        sendNext();
+    }
+}
+
+void xrEngine::reply(Request req, const QByteArray &line)
+{
+    if(req.isJudge)
+    {
+        QList<QByteArray> word = line.split(' ');
+        int over = word.size() == 2 && word[0] == "RESULT" ? word[1].toInt() : -1;
+
+        if(req.pos < 0)
+            emit judged(req.owner, over);
+        else
+            emit moved(req.owner, over < 0 ? -1 : req.pos, over);
+        return;
+    }
+
+    QList<QByteArray> xy = line.split(',');
+    if(xy.size() != 2)
+    {
+        emit moved(req.owner, -1, -1);
+        return;
+    }
+
+    // judge the engine move before reporting it
+    req.isJudge = true;
+    req.pos = xy[1].toInt()*15 + xy[0].toInt();
+    req.moves.append(req.pos);
+    req.text = boardText("JUDGE", req.moves);
+    requests.prepend(req);
+}
+
+// fail the pending requests, the process is started again by the next one
+void xrEngine::processDied()
+{
+    QQueue<Request> failed;
+
+    started = false;
+    waiting = false;
+    failed.swap(requests);
+
+    for(int i = 0; i < failed.size(); i++)
+    {
+        if(failed[i].cancelled)
+            continue;
+        if(failed[i].isJudge && failed[i].pos < 0)
+            emit judged(failed[i].owner, -1);
+        else
+            emit moved(failed[i].owner, -1, -1);
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef XRENGINE_H
+#define XRENGINE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QQueue>
+#include <QString>
+#include <QVector>
+
+// Client of the headless engine (Tools/engine.c) shared by all rooms.
+// Requests are sent one at a time, every request gets one reply line.
+class xrEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    // the shared engine, nullptr unless enabled
+    static xrEngine *shared();
+    static void enable(const QString &program);
+
+    bool isReady() const;
+
+    // moves are positions 15*row+col in playing order, black first
+    void judge(const QVector<int> &moves, QObject *owner);
+    void think(const QVector<int> &moves, const QString &profile, bool forbidden, QObject *owner);
+    void stop(QObject *owner);
+
+signals:
+    void ready();
+    // isOver and pos are -1 if the engine fails
+    void judged(QObject *owner, int isOver);
+    void moved(QObject *owner, int pos, int isOver);
+
+private slots:
+    void readReply();
+    void processDied();
+
+private:
+    explicit xrEngine(const QString &program, QObject *parent = nullptr);
+    ~xrEngine();
+
+    struct Request {
+        QObject *owner;
+        bool isJudge;
+        bool cancelled;
+        int pos;                // engine move being judged, or -1
+        QVector<int> moves;
+        QByteArray text;
+    };
+
+    void launch();
+    void post(const Request &req);
+    void sendNext();
+    void reply(Request req, const QByteArray &line);
+    static QByteArray boardText(const char *cmd, const QVector<int> &moves);
+
+    static xrEngine *instance;
+
+    QProcess process;
+    QString program;
+    bool started;
+    bool waiting;               // the front request is sent
+    QQueue<Request> requests;
+};
+
+#endif // XRENGINE_H
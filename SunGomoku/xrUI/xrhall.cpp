@@ -1,5 +1,6 @@
 #include "xrhall.h"
 #include "ui_xrhall.h"
+#include "xrengine.h"
 #include "Kernel/uiinc.h"
 #include "Kernel/macro.h"
 
@@ -9,8 +10,6 @@ xrHall::xrHall(QWidget *parent) :
 {
     ui->setupUi(this);
 
-    initialize();
-
     this->setWindowTitle("Welcome to SunGomoku!");
 
     vtext = "AI v1.1.3, UI v1.4-beta2";
@@ -27,6 +26,62 @@ xrHall::xrHall(QWidget *parent) :
     edition->addButton(ui->pubEdition,0);
     ui->proEdition->setChecked(true);
     set_forbidden(edition->checkedId());
+
+    // tables are built in the background, start is enabled when they are ready
+    listed = false;
+    pending = false;
+    startText = ui->startButton->text();
+    setLoading();
+
+    // an engine process builds its own tables, the gui only needs profiles
+    xrEngine *engine = xrEngine::shared();
+    if(engine != nullptr)
+    {
+        load_profiles("profiles.ini");
+        connect(engine, SIGNAL(ready()), this, SLOT(engineReady()));
+        if(engine->isReady())
+            engineReady();
+    }
+    else
+        initialize_async(engineReadyCallback, this);
+}
+
+// called on the initialization thread
+void xrHall::engineReadyCallback(void *hall)
+{
+    QMetaObject::invokeMethod(static_cast<xrHall *>(hall), "engineReady", Qt::QueuedConnection);
+}
+
+void xrHall::engineReady()
+{
+    // the engine process signals again after a restart
+    if(ready)
+        return;
+    ready = true;
+
+    // profiles from profiles.ini follow the six built-in ones
+    if(!listed)
+    {
+        for(int i = 6; i < get_profile_num(); i++)
+            ui->modelBox->addItem(get_profile_name(i));
+        listed = true;
+    }
+
+    ui->startButton->setText(startText);
+    ui->startButton->setEnabled(true);
+
+    if(pending)
+    {
+        pending = false;
+        game();
+    }
+}
+
+void xrHall::setLoading()
+{
+    ready = false;
+    ui->startButton->setText(QStringLiteral("加载中…"));
+    ui->startButton->setEnabled(false);
 }
 
 xrHall::~xrHall()
@@ -37,13 +92,41 @@ xrHall::~xrHall()
 
 void xrHall::game()
 {
+    QString profile;
+    int rule = edition->checkedId();
+
+    // the rule follows the edition, the pattern tables of this process are
+    // built again for it before the game starts
+    if(rule != get_forbidden())
+    {
+        set_forbidden(rule);
+        if(xrEngine::shared() == nullptr)
+        {
+            setLoading();
+            pending = true;
+            initialize_async(engineReadyCallback, this);
+            return;
+        }
+    }
+
     depth = ui->modelBox->currentIndex();
-    set_difficulty(depth);
-    room = new xrRoom(vtext, depth, chesscolor->checkedId());
+    if(depth < 3)
+    {
+        set_difficulty(depth);
+        profile = get_profile_name(edition->checkedId() ? depth : depth + 3);
+    }
+    else
+    {
+        set_profile(ui->modelBox->currentText().toUtf8().constData());
+        profile = ui->modelBox->currentText();
+    }
+    room = new xrRoom(vtext, depth, chesscolor->checkedId(), profile);
     room->show();
 }
 
 void xrHall::on_startButton_clicked()
 {
+    if(!ready)
+        return;
     game();
 }
@@ -24,12 +24,21 @@ private slots:
 
     void on_startButton_clicked();
 
+    void engineReady();
+
 private:
+    static void engineReadyCallback(void *hall);
+    void setLoading();
+
     Ui::xrHall *ui;
     QButtonGroup * chesscolor;
     QButtonGroup * edition;
     xrRoom * room;
     QString vtext;
+    QString startText;
+    bool ready;
+    bool listed;                // profiles from profiles.ini are in modelBox
+    bool pending;               // a game starts when the engine is ready
     int depth;
 };
 
@@ -1,5 +1,6 @@
 #include "xrroom.h"
 #include "ui_xrroom.h"
+#include "xrengine.h"
 #include "Kernel/uiinc.h"
 #include "Kernel/macro.h"
 
@@ -8,13 +9,51 @@
 #include <QMessageBox>
 #include <QProcess>
 #include <QToolBar>
+#include <QThreadPool>
+#include <QtConcurrent>
 
-xrRoom::xrRoom(QString vtext, int depth, int color, QWidget *parent) :
+// every in-process search runs on one thread kept for the whole program, so
+// the per-thread kernel caches stay warm and no search overlaps another
+static QThreadPool *aiPool()
+{
+    static QThreadPool pool;
+    if(pool.maxThreadCount() != 1){
+        pool.setMaxThreadCount(1);
+        pool.setExpiryTimeout(-1);
+    }
+    return &pool;
+}
+
+xrRoom::xrRoom(QString vtext, int depth, int color, QString profile, QWidget *parent) :
     QMainWindow(parent), chessboard(),
     ui(new Ui::xrRoom)
 {
     ui->setupUi(this);
 
+    aiPending = false;
+    connect(&aiWatcher, SIGNAL(finished()), this, SLOT(aiDone()));
+
+    moveX = -1;
+    moveY = -1;
+    stoneStamp = -1;
+
+    // progress in the status bar, principal variation on the board if checked
+    hasProgress = false;
+    progressTimer.setInterval(50);
+    connect(&progressTimer, SIGNAL(timeout()), this, SLOT(showProgress()));
+    pvAction = ui->toolBar->addAction(QStringLiteral("PV"));
+    pvAction->setCheckable(true);
+    connect(pvAction, SIGNAL(toggled(bool)), this, SLOT(update()));
+
+    // search in the shared engine process if there is one
+    engineProfile = profile;
+    engineRule = get_forbidden();
+    engine = xrEngine::shared();
+    if(engine != nullptr){
+        connect(engine, SIGNAL(judged(QObject*,int)), this, SLOT(engineJudged(QObject*,int)));
+        connect(engine, SIGNAL(moved(QObject*,int,int)), this, SLOT(engineMoved(QObject*,int,int)));
+    }
+
     this->setWindowModality(Qt::ApplicationModal);
 
     playerColor = color;
@@ -44,13 +83,19 @@ xrRoom::xrRoom(QString vtext, int depth, int color, QWidget *parent) :
 
 xrRoom::~xrRoom()
 {
+    stopAi();
     delete ui;
 }
 
-void xrRoom::paintEvent(QPaintEvent *)
+// draw the wooden board, the grid and the star points into boardLayer
+void xrRoom::paintBoard()
 {
-    paintRatio();
-    QPainter painter(this);
+    qreal dpr = devicePixelRatioF();
+    boardLayer = QPixmap(size()*dpr);
+    boardLayer.setDevicePixelRatio(dpr);
+    boardLayer.fill(Qt::transparent);
+
+    QPainter painter(&boardLayer);
     painter.setRenderHint(QPainter::Antialiasing, true);
     QPen pen=painter.pen();
     pen.setColor(QColor("#8D5822"));
@@ -76,11 +121,27 @@ void xrRoom::paintEvent(QPaintEvent *)
     painter.drawEllipse(QPoint(beginX+3*gap, beginY+11*gap), eighthGap, eighthGap);
     painter.drawEllipse(QPoint(beginX+11*gap, beginY+11*gap), eighthGap, eighthGap);
     painter.drawEllipse(QPoint(beginX+7*gap, beginY+7*gap), eighthGap, eighthGap);
+
+    // the stones go on top of the new board
+    stoneStamp = -1;
+}
+
+// draw the stones over boardLayer into stoneLayer
+void xrRoom::paintStones()
+{
+    stoneLayer = boardLayer;
+    stoneStamp = chessboard.stamp;
+
+    QPainter painter(&stoneLayer);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    QBrush brush;
+    brush.setStyle(Qt::SolidPattern);
     //画棋子
     for (int i = 0; i < 15; ++i) {
         for (int j = 0; j < 15; ++j) {
             if (chessboard.chess[i][j] == 1){
                 brush.setColor(Qt::black);
+                painter.setPen(Qt::black);
                 painter.setBrush(brush);
                 painter.drawEllipse(QPoint(j*gap+beginX, i*gap+beginY), r, r);
             }
@@ -92,6 +153,40 @@ void xrRoom::paintEvent(QPaintEvent *)
             }
         }
     }
+}
+
+// the area drawn by the hover cursor of a cell
+QRect xrRoom::cursorRect(int x, int y) const
+{
+    return QRect(y*gap+beginX-halfGap-2, x*gap+beginY-halfGap-2, gap+4, gap+4);
+}
+
+void xrRoom::paintEvent(QPaintEvent *event)
+{
+    paintRatio();
+    if(stoneStamp != chessboard.stamp)
+        paintStones();
+
+    QPainter painter(this);
+    painter.setClipRect(event->rect());
+    painter.drawPixmap(0, 0, stoneLayer);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    QPen pen=painter.pen();
+
+    //思考中的主要变例
+    if(hasProgress && pvAction->isChecked())
+    {
+        for(int i = 0; i < progress.pvlen; i++)
+        {
+            int x = progress.pv[i]/15, y = progress.pv[i]%15;
+            bool black = (i%2 == 0) == (aiColor == 1);
+            painter.setPen(Qt::NoPen);
+            painter.setBrush(black ? QColor(0, 0, 0, 96) : QColor(255, 255, 255, 128));
+            painter.drawEllipse(QPoint(y*gap+beginX, x*gap+beginY), r, r);
+            painter.setPen(Qt::red);
+            painter.drawText(QRect(y*gap+beginX-r, x*gap+beginY-r, 2*r, 2*r), Qt::AlignCenter, QString::number(i+1));
+        }
+    }
     //鼠标当前位置的光标
     pen.setColor(Qt::red);
     pen.setWidth(1);
@@ -116,14 +211,19 @@ void xrRoom::paintEvent(QPaintEvent *)
     painter.drawLine(currentY*gap+beginX+pen2, currentX*gap+beginY, currentY*gap+beginX+pen2+eighthGap, currentX*gap+beginY);
     painter.drawLine(currentY*gap+beginX, currentX*gap+beginY-pen2, currentY*gap+beginX, currentX*gap+beginY-pen2-eighthGap);
     painter.drawLine(currentY*gap+beginX, currentX*gap+beginY+pen2, currentY*gap+beginX, currentX*gap+beginY+pen2+eighthGap);
-
-    isPaint=true;
 }
 
 void xrRoom::mouseMoveEvent(QMouseEvent *event){
-    moveX=(event->y()-beginY+halfGap)/gap;
-    moveY=(event->x()-beginX+halfGap)/gap;
-    update();
+    int x=(event->y()-beginY+halfGap)/gap;
+    int y=(event->x()-beginX+halfGap)/gap;
+    if(x==moveX && y==moveY)
+        return;
+
+    // only the old and the new cursor are repainted
+    update(cursorRect(moveX, moveY));
+    moveX=x;
+    moveY=y;
+    update(cursorRect(moveX, moveY));
 }
 
 void xrRoom::mouseReleaseEvent(QMouseEvent *event)
@@ -151,20 +251,30 @@ void xrRoom::mouseReleaseEvent(QMouseEvent *event)
 void xrRoom::on_actionUndo_triggered()
 {
     int currentPos, t;
+    stopAi();
     currentPos=15*currentX+currentY;
     if(chessboard.player >= 2){
         t = (playerColor+chessboard.player)%2+1;
         currentPos=chessboard.undo(t);
-        undo_move(t);
+        if(engine == nullptr)
+            undo_move(t);
     }
     currentX=currentPos/15;
     currentY=currentPos%15;
     update();
+
+    // the first ai move was cancelled, play it again
+    if(chessboard.player == 0 && playerColor == 2){
+        mouseflag=false;
+        aiGo();
+        return;
+    }
     mouseflag=true;
 }
 
 void xrRoom::on_actionRestart_triggered()
 {
+    stopAi();
     chessboard.cleanup();
     restart();
     update();
@@ -176,6 +286,13 @@ void xrRoom::on_actionQuit_triggered()
     this->close();
 }
 
+void xrRoom::closeEvent(QCloseEvent *event)
+{
+    // the kernel board is shared with the next room
+    stopAi();
+    QMainWindow::closeEvent(event);
+}
+
 void xrRoom::begin(){
 
     chessboard.cleanup();
@@ -183,28 +300,28 @@ void xrRoom::begin(){
     currentX = 0;
     currentY = 0;
     isOver = 0;
-    isPaint = true;
 
     if (playerColor==2){
-        aiPos = ai_do_move(&isOver, aiColor);
-        currentX=aiPos/15;
-        currentY=aiPos%15;
-        chessboard.go(currentX, currentY);
-        update();
+        mouseflag=false;
+        aiGo();
     }
-
-    mouseflag=true;
+    else
+        mouseflag=true;
 }
 
 void xrRoom::playerGo()
 {
-    isPaint=false;
-    while (!isPaint) {
-        repaint();
+    mouseflag=false;
+    if(engine != nullptr){
+        engine->judge(chessboard.moves(), this);
+        return;
     }
-
     player_do_move(currentX, currentY, &isOver, playerColor);
+    playerDone();
+}
 
+void xrRoom::playerDone()
+{
     if(isOver==playerColor){
         QMessageBox::about(this, QStringLiteral("Win"), QStringLiteral("You win!"));
         mouseflag=false;
@@ -225,7 +342,70 @@ void xrRoom::playerGo()
 
 void xrRoom::aiGo()
 {
-    aiPos = ai_do_move(&isOver, aiColor);
+    int color = aiColor;
+
+    // the board stays responsive, input is blocked by mouseflag until aiDone()
+    ui->statusbar->showMessage(QStringLiteral("AI 思考中…"));
+    aiPending = true;
+    if(engine != nullptr){
+        engine->think(chessboard.moves(), engineProfile, engineRule, this);
+        return;
+    }
+    poll_progress(&progress);       // drop what the last search left
+    hasProgress = false;
+    progressTimer.start();
+    aiWatcher.setFuture(QtConcurrent::run(aiPool(), [color]() {
+        int over = 0;
+        int pos = ai_do_move(&over, color);
+        return qMakePair(pos, over);
+    }));
+}
+
+// called through the watcher's queued finished signal
+void xrRoom::aiDone()
+{
+    if(!aiPending)
+        return;
+    aiPending = false;
+    ui->statusbar->clearMessage();
+    progressTimer.stop();
+    hasProgress = false;
+
+    aiPos = aiWatcher.result().first;
+    isOver = aiWatcher.result().second;
+    if(aiPos < 0)
+        return;
+    aiMoved();
+}
+
+static QString moveName(int pos)
+{
+    return QString(QChar('A'+pos%15)) + QString::number(15-pos/15);
+}
+
+void xrRoom::showProgress()
+{
+    if(!aiPending || !poll_progress(&progress))
+        return;
+    hasProgress = true;
+
+    QString pv;
+    for(int i = 0; i < progress.pvlen; i++)
+        pv += " " + moveName(progress.pv[i]);
+
+    QString text = QStringLiteral("深度 %1  节点 %2  %3 kN/s").arg(progress.dep)
+            .arg(progress.nodes).arg(progress.nps/1000);
+    if(progress.best < 15*15)
+        text += QStringLiteral("  最佳 %1  分数 %2  PV%3").arg(moveName(progress.best))
+                .arg(progress.score).arg(pv);
+    ui->statusbar->showMessage(text);
+
+    if(pvAction->isChecked())
+        update();
+}
+
+void xrRoom::aiMoved()
+{
     currentX = aiPos/15;
     currentY = aiPos%15;
     chessboard.go(currentX, currentY);
@@ -248,6 +428,69 @@ void xrRoom::aiGo()
     }
 }
 
+void xrRoom::engineJudged(QObject *owner, int over)
+{
+    if(owner != this)
+        return;
+    if(over < 0){
+        engineLost();
+        return;
+    }
+    isOver = over;
+    playerDone();
+}
+
+void xrRoom::engineMoved(QObject *owner, int pos, int over)
+{
+    if(owner != this || !aiPending)
+        return;
+    aiPending = false;
+    ui->statusbar->clearMessage();
+
+    if(pos < 0){
+        engineLost();
+        return;
+    }
+    aiPos = pos;
+    isOver = over;
+    aiMoved();
+}
+
+// the game can go on after an undo or a restart, which start the engine again
+void xrRoom::engineLost()
+{
+    QMessageBox::about(this, QStringLiteral("Error"), QStringLiteral("引擎错误"));
+    mouseflag=false;
+}
+
+// cancel a running search, a move it already made is taken back
+void xrRoom::stopAi()
+{
+    // the engine process is told the whole board with every request, so
+    // dropping the requests of this room is enough, a judgement included
+    if(engine != nullptr)
+        engine->stop(this);
+
+    if(!aiPending)
+        return;
+    aiPending = false;
+    ui->statusbar->clearMessage();
+    isOver = 0;
+    mouseflag = true;
+    if(engine != nullptr)
+        return;
+
+    abort_search(1);
+    aiWatcher.waitForFinished();
+    abort_search(0);
+    progressTimer.stop();
+    hasProgress = false;
+    update();
+
+    if(aiWatcher.result().first >= 0)
+        undo_move(1);
+}
+
 void xrRoom::paintRatio()
 {
     gap = qMin(this->centralWidget()->width()/16, this->centralWidget()->height()/16);
@@ -266,4 +509,14 @@ void xrRoom::paintRatio()
     eighthGap = gap/8;
 
     r = gap*40/100;
+
+    // the cached board only depends on the geometry
+    if(size() != boardSize || beginX != boardX || beginY != boardY || gap != boardGap
+            || boardLayer.devicePixelRatio() != devicePixelRatioF()){
+        boardSize = size();
+        boardX = beginX;
+        boardY = beginY;
+        boardGap = gap;
+        paintBoard();
+    }
 }
@@ -3,10 +3,20 @@
 
 #include <QMainWindow>
 #include <QMouseEvent>
+#include <QCloseEvent>
 #include <QString>
 #include <QTime>
 #include <QtGlobal>
+#include <QFutureWatcher>
+#include <QPair>
+#include <QTimer>
+#include <QPixmap>
+#include <QPaintEvent>
+#include <QAction>
 #include "chessboard.h"
+#include "Kernel/progress.h"
+
+class xrEngine;
 
 namespace Ui {
 class xrRoom;
@@ -17,17 +27,25 @@ class xrRoom : public QMainWindow
     Q_OBJECT
 
 public:
-    explicit xrRoom(QString vtext, int depth, int isFirst, QWidget *parent = nullptr);
+    explicit xrRoom(QString vtext, int depth, int isFirst, QString profile = QString(), QWidget *parent = nullptr);
     ~xrRoom();
     virtual void paintEvent(QPaintEvent *);
     void mouseReleaseEvent(QMouseEvent *);
     void mouseMoveEvent(QMouseEvent *);
+    void closeEvent(QCloseEvent *);
 
     void paintRatio();
+    void paintBoard();
+    void paintStones();
+    QRect cursorRect(int x, int y) const;
 
     void begin();
     void playerGo();
+    void playerDone();
     void aiGo();
+    void aiMoved();
+    void stopAi();
+    void engineLost();
 
     chessboard chessboard;
     bool mouseflag;
@@ -40,6 +58,14 @@ private slots:
 
     void on_actionQuit_triggered();
 
+    void aiDone();
+
+    void showProgress();
+
+    void engineJudged(QObject *owner, int over);
+
+    void engineMoved(QObject *owner, int pos, int over);
+
 private:
     Ui::xrRoom *ui;
 
@@ -49,7 +75,28 @@ private:
     int aiColor;
     int aiPos;
     int isOver;
-    bool isPaint;
+
+    // search running on a worker thread, result is (position, isOver)
+    QFutureWatcher<QPair<int, int> > aiWatcher;
+    bool aiPending;
+
+    // search progress, polled while the ai thinks
+    QTimer progressTimer;
+    progress_t progress;
+    bool hasProgress;
+    QAction *pvAction;
+
+    // engine process, nullptr to search in this process
+    xrEngine *engine;
+    QString engineProfile;
+    bool engineRule;            // rule of the game, fixed when the room opens
+
+    // board and stones are cached, redrawn on resize and on moves
+    QPixmap boardLayer;
+    QPixmap stoneLayer;
+    QSize boardSize;
+    int boardX, boardY, boardGap;
+    int stoneStamp;
 
     int beginX, beginY, endX, endY, centerX, centerY;
     int gap, halfGap, quarGap, eighthGap;